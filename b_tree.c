@@ -1,10 +1,25 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #define MAX_NODES 500
 #define BUF_SIZ 512
 
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+
+#define DIE(assertion, call_description)            \
+    do                                              \
+    {                                               \
+        if (assertion)                              \
+        {                                           \
+            fprintf(stderr, "(%s, %d): ", __FILE__, \
+                    __LINE__);                      \
+            perror(call_description);               \
+            exit(errno);                            \
+        }                                           \
+    } while (0)
+
 typedef struct queue_t queue_t;
 struct queue_t
 {
@@ -20,6 +35,12 @@ struct queue_t
     unsigned int write_idx;
     /* Bufferul ce stocheaza elementele cozii */
     void **buff;
+    /*
+     * Doar pentru q_create_ring: elementele stau direct aici, cate data_size
+     * octeti fiecare; max_size e putere a lui 2 si se dubleaza cand coada se
+     * umple (buff e NULL)
+     */
+    unsigned char *ring;
 };
 
 typedef struct b_node_t b_node_t;
@@ -59,6 +80,45 @@ q_create(unsigned int data_size, unsigned int max_size)
     return q;
 }
 
+/*
+ * Coada fara malloc per element, care creste singura. Pointerul intors de
+ * q_front e valid doar pana la urmatorul q_enqueue.
+ */
+queue_t *
+q_create_ring(unsigned int data_size, unsigned int capacity)
+{
+    queue_t *q = calloc(1, sizeof(*q));
+    DIE(!q, "calloc queue failed");
+
+    q->data_size = data_size;
+    q->max_size = 16;
+    while (q->max_size < capacity)
+        q->max_size *= 2;
+
+    q->ring = malloc((size_t)q->max_size * data_size);
+    DIE(!q->ring, "malloc ring failed");
+
+    return q;
+}
+
+static void q_grow_ring(queue_t *q)
+{
+    size_t stride = q->data_size;
+    unsigned int first = q->max_size - q->read_idx;
+    unsigned char *ring = malloc(2 * (size_t)q->max_size * stride);
+    DIE(!ring, "malloc ring failed");
+
+    /* coada e plina: de la read_idx pana la capat, apoi de la inceput */
+    memcpy(ring, q->ring + q->read_idx * stride, first * stride);
+    memcpy(ring + first * stride, q->ring, q->read_idx * stride);
+
+    free(q->ring);
+    q->ring = ring;
+    q->read_idx = 0;
+    q->write_idx = q->max_size;
+    q->max_size *= 2;
+}
+
 unsigned int
 q_get_size(queue_t *q)
 {
@@ -77,6 +137,9 @@ q_front(queue_t *q)
     if (!q || !q->size)
         return NULL;
 
+    if (q->ring)
+        return q->ring + (size_t)q->read_idx * q->data_size;
+
     return q->buff[q->read_idx];
 }
 
@@ -85,6 +148,12 @@ int q_dequeue(queue_t *q)
     if (!q || !q->size)
         return 0;
 
+    if (q->ring) {
+        q->read_idx = (q->read_idx + 1) & (q->max_size - 1);
+        --q->size;
+        return 1;
+    }
+
     free(q->buff[q->read_idx]);
 
     q->read_idx = (q->read_idx + 1) % q->max_size;
@@ -95,6 +164,18 @@ int q_dequeue(queue_t *q)
 int q_enqueue(queue_t *q, void *new_data)
 {
     void *data;
+
+    if (q && q->ring) {
+        if (q->size == q->max_size)
+            q_grow_ring(q);
+
+        memcpy(q->ring + (size_t)q->write_idx * q->data_size, new_data,
+               q->data_size);
+        q->write_idx = (q->write_idx + 1) & (q->max_size - 1);
+        ++q->size;
+        return 1;
+    }
+
     if (!q || q->size == q->max_size)
         return 0;
 
@@ -115,7 +196,7 @@ void q_clear(queue_t *q)
     if (!q || !q->size)
         return;
 
-    for (i = q->read_idx; i != q->write_idx; i = (i + 1) % q->max_size)
+    for (i = q->read_idx; q->buff && i != q->write_idx; i = (i + 1) % q->max_size)
         free(q->buff[i]);
 
     q->read_idx = 0;
@@ -130,6 +211,7 @@ void q_free(queue_t *q)
 
     q_clear(q);
     free(q->buff);
+    free(q->ring);
     free(q);
 }
 
@@ -185,7 +267,7 @@ void b_tree_insert(b_tree_t *b_tree, void *data)
         return;
     }
 
-    q = q_create(sizeof(b_node_t *), MAX_NODES);
+    q = q_create_ring(sizeof(b_node_t *), MAX_NODES);
 
     /* TODO */
     q_enqueue(q, &(b_tree->root));
@@ -390,10 +472,11 @@ ll_add_nth_node(linked_list_t* list, unsigned int n, const void* new_data)
         --n;
     }
 
-    new_node = malloc(sizeof(*new_node));
+    /* Nodul si datele lui sunt alocate dintr-o singura bucata: datele stau
+     * imediat dupa nod, deci un singur free(nod) elibereaza tot. */
+    new_node = malloc(sizeof(*new_node) + list->data_size);
     DIE(new_node == NULL, "new_node malloc");
-    new_node->data = malloc(list->data_size);
-    DIE(new_node->data == NULL, "new_node->data malloc");
+    new_node->data = new_node + 1;
     memcpy(new_node->data, new_data, list->data_size);
 
     new_node->next = curr;
@@ -411,7 +494,7 @@ ll_add_nth_node(linked_list_t* list, unsigned int n, const void* new_data)
  * parametru. Pozitiile din lista se indexeaza de la 0. Daca n >= nr_noduri - 1,
  * se elimina nodul de la finalul listei. Daca n < 0, eroare. Functia intoarce
  * un pointer spre nodul eliminat din lista. Este responsabilitatea apelantului
- * sa elibereze memoria acestui nod.
+ * sa elibereze memoria acestui nod (un singur free, datele sunt in nod).
  */
 ll_node_t *
 ll_remove_nth_node(linked_list_t* list, unsigned int n)
@@ -477,8 +560,6 @@ ll_free(linked_list_t** pp_list)
 
     while (ll_get_size(*pp_list) > 0) {
         curr_node = ll_remove_nth_node(*pp_list, 0);
-        free(curr_node->data);
-        curr_node->data = NULL;
         free(curr_node);
         curr_node = NULL;
     }
@@ -604,7 +685,6 @@ st_pop(stack_t *st)
         return;
     }
     ll_node_t *tmp = ll_remove_nth_node(st->list, 0);
-    free(tmp->data);
     free(tmp);
     
 }
@@ -645,94 +725,229 @@ st_free(stack_t *st)
 }
 
 
+/*
+ * Arbore binar cu tip fix: BT_DEFINE_TREE(name, T) genereaza name_b_node_t,
+ * care tine valoarea T direct in nod (un singur malloc, fara memcpy), si
+ * name_b_tree_t cu init / insert / free. Inserarea e ca la b_tree_insert:
+ * primul loc liber in ordinea nivelurilor. Arborele generic cu void * ramane
+ * pentru date de alte tipuri.
+ */
+#define BT_DEFINE_TREE(name, T)                                             \
+typedef struct name##_b_node_t name##_b_node_t;                             \
+struct name##_b_node_t                                                      \
+{                                                                           \
+    name##_b_node_t *left;                                                  \
+    name##_b_node_t *right;                                                 \
+    T data;                                                                 \
+};                                                                          \
+                                                                            \
+typedef struct                                                              \
+{                                                                           \
+    name##_b_node_t *root;                                                  \
+    unsigned int size;                                                      \
+} name##_b_tree_t;                                                          \
+                                                                            \
+static inline void name##_b_tree_init(name##_b_tree_t *tree)                \
+{                                                                           \
+    tree->root = NULL;                                                      \
+    tree->size = 0;                                                         \
+}                                                                           \
+                                                                            \
+static inline void name##_b_tree_insert(name##_b_tree_t *tree, T data)      \
+{                                                                           \
+    name##_b_node_t *node = malloc(sizeof(*node));                          \
+    DIE(!node, "b_node malloc");                                            \
+    node->left = node->right = NULL;                                        \
+    node->data = data;                                                      \
+                                                                            \
+    if (!tree->root) {                                                      \
+        tree->root = node;                                                  \
+        tree->size = 1;                                                     \
+        return;                                                             \
+    }                                                                       \
+                                                                            \
+    /* coada pe nivel: un vector simplu, fiecare nod intra o singura data */ \
+    name##_b_node_t **q = malloc((tree->size + 1) * sizeof(*q));            \
+    DIE(!q, "malloc queue failed");                                         \
+    unsigned int head = 0, tail = 0;                                        \
+    q[tail++] = tree->root;                                                 \
+                                                                            \
+    while (head != tail) {                                                  \
+        name##_b_node_t *crt = q[head++];                                   \
+                                                                            \
+        if (!crt->left) {                                                   \
+            crt->left = node;                                               \
+            break;                                                          \
+        }                                                                   \
+        if (!crt->right) {                                                  \
+            crt->right = node;                                              \
+            break;                                                          \
+        }                                                                   \
+        q[tail++] = crt->left;                                              \
+        q[tail++] = crt->right;                                             \
+    }                                                                       \
+                                                                            \
+    tree->size++;                                                           \
+    free(q);                                                                \
+}                                                                           \
+                                                                            \
+static inline void name##_b_node_free(name##_b_node_t *node)                \
+{                                                                           \
+    if (!node)                                                              \
+        return;                                                             \
+    name##_b_node_free(node->left);                                         \
+    name##_b_node_free(node->right);                                        \
+    free(node);                                                             \
+}                                                                           \
+                                                                            \
+static inline void name##_b_tree_free(name##_b_tree_t *tree)                \
+{                                                                           \
+    name##_b_node_free(tree->root);                                         \
+    name##_b_tree_init(tree);                                               \
+}
+
+BT_DEFINE_TREE(int, int)
+
 
 // ------------------- CHEAT SHEET START HERE -------------------
 
 // BFS, DFS, level k printing, level printing, mirror, height, find node, LCA
 
-void BFS(b_tree_t *b_tree, void (*print_func)(void *))
-{
-    queue_t *q;
-    b_node_t *b_node;
-
-    if (!b_tree || !b_tree->root)
-        return;
+/*
+ * Parcurgere pe niveluri fara printf. visit(nod, nivel, arg) e apelat pe
+ * fiecare nod si opreste parcurgerea intorcand != 0. Functiile de afisare de
+ * mai jos sunt construite peste ea.
+ */
+typedef int (*b_visit_fn)(b_node_t *node, int level, void *arg);
 
-    q = q_create(sizeof(b_node_t *), MAX_NODES);
-    q_enqueue(q, &(b_tree->root));
+typedef struct {
+    b_node_t *node;
+    int parent;     // indicele parintelui in ordinea BFS
+} bfs_item_t;
 
-    while (!q_is_empty(q)) {
-        b_node = *(b_node_t **)q_front(q);
-        q_dequeue(q);
+static inline int b_tree_bfs_core(b_tree_t *b_tree, int max_level, b_node_t **order,
+                                  int *levels, int *parents, b_visit_fn visit, void *arg)
+{
+    int count = 0, depth = 0, stop = 0;
+    queue_t *q = q_create_ring(sizeof(bfs_item_t), MAX_NODES);
+    bfs_item_t item = { b_tree->root, -1 };
+    q_enqueue(q, &item);
 
-        print_func(b_node->data);
+    while (!q_is_empty(q) && !stop) {
+        int level_size = q_get_size(q);
+        for (int i = 0; i < level_size; i++) {
+            item = *(bfs_item_t *)q_front(q);
+            q_dequeue(q);
 
-        if (b_node->left)
-            q_enqueue(q, &(b_node->left));
-        if (b_node->right)
-            q_enqueue(q, &(b_node->right));
+            if (order)
+                order[count] = item.node;
+            if (levels)
+                levels[count] = depth;
+            if (parents)
+                parents[count] = item.parent;
+            int idx = count++;
+            if (visit && visit(item.node, depth, arg)) {
+                stop = 1;
+                break;
+            }
+            if (depth == max_level)
+                continue;
+
+            bfs_item_t child = { NULL, idx };
+            if ((child.node = item.node->left))
+                q_enqueue(q, &child);
+            if ((child.node = item.node->right))
+                q_enqueue(q, &child);
+        }
+        depth++;
     }
 
     q_free(q);
+    return count;
 }
 
-void print_level_k(b_tree_t *b_tree, int k, void (*print_func)(void *))
+/*
+ * BFS cu rezultatele in vectori, indexati dupa ordinea vizitarii: order[i] =
+ * al i-lea nod, levels[i] = nivelul lui, parents[i] = indicele parintelui
+ * (-1 la radacina). Se opreste dupa nivelul max_level (< 0 = fara limita);
+ * oricare vector poate fi NULL. Intoarce numarul de noduri vizitate.
+ */
+int b_tree_bfs(b_tree_t *b_tree, int max_level, b_node_t **order, int *levels, int *parents)
 {
-    if (!b_tree || !b_tree->root || k < 0)
-        return;
+    if (!b_tree || !b_tree->root)
+        return 0;
 
-    queue_t *q = q_create(sizeof(b_node_t *), MAX_NODES);
-    q_enqueue(q, &(b_tree->root));
+    return b_tree_bfs_core(b_tree, max_level, order, levels, parents, NULL, NULL);
+}
 
-    int level = 0;
-    while (!q_is_empty(q)) {
-        int level_size = q_get_size(q); // corectat aici
-        for (int i = 0; i < level_size; i++) {
-            b_node_t *b_node = *(b_node_t **)q_front(q);
-            q_dequeue(q);
+int b_tree_bfs_visit(b_tree_t *b_tree, int max_level, b_visit_fn visit, void *arg)
+{
+    if (!b_tree || !b_tree->root)
+        return 0;
 
-            if (level == k) {
-                print_func(b_node->data);
-            }
+    return b_tree_bfs_core(b_tree, max_level, NULL, NULL, NULL, visit, arg);
+}
 
-            if (b_node->left)
-                q_enqueue(q, &(b_node->left));
-            if (b_node->right)
-                q_enqueue(q, &(b_node->right));
-        }
-        if (level == k)
-            break;
-        level++;
-    }
+typedef struct {
+    void (*print_func)(void *);
+    int level;      // nivelul de afisat / nivelul randului curent
+} print_visit_t;
 
-    q_free(q);
+static int print_visit(b_node_t *node, int level, void *arg)
+{
+    (void)level;
+    ((print_visit_t *)arg)->print_func(node->data);
+    return 0;
 }
 
-void print_bfs_levels(b_tree_t *b_tree, void (*print_func)(void *))
+void BFS(b_tree_t *b_tree, void (*print_func)(void *))
 {
     if (!b_tree || !b_tree->root)
         return;
 
-    queue_t *q = q_create(sizeof(b_node_t *), MAX_NODES);
-    q_enqueue(q, &(b_tree->root));
+    print_visit_t p = { print_func, 0 };
+    b_tree_bfs_core(b_tree, -1, NULL, NULL, NULL, print_visit, &p);
+}
 
-    while (!q_is_empty(q)) {
-        int level_size = q_get_size(q);
-        for (int i = 0; i < level_size; i++) {
-            b_node_t *b_node = *(b_node_t **)q_front(q);
-            q_dequeue(q);
+static int print_level_k_visit(b_node_t *node, int level, void *arg)
+{
+    print_visit_t *p = arg;
 
-            print_func(b_node->data);
+    if (level == p->level)
+        p->print_func(node->data);
+    return 0;
+}
 
-            if (b_node->left)
-                q_enqueue(q, &(b_node->left));
-            if (b_node->right)
-                q_enqueue(q, &(b_node->right));
-        }
+void print_level_k(b_tree_t *b_tree, int k, void (*print_func)(void *))
+{
+    if (!b_tree || !b_tree->root || k < 0)
+        return;
+
+    print_visit_t p = { print_func, k };
+    b_tree_bfs_core(b_tree, k, NULL, NULL, NULL, print_level_k_visit, &p);
+}
+
+// rand nou cand se schimba nivelul
+static int print_levels_visit(b_node_t *node, int level, void *arg)
+{
+    print_visit_t *p = arg;
+
+    if (level != p->level) {
         printf("\n");
+        p->level = level;
     }
+    p->print_func(node->data);
+    return 0;
+}
 
-    q_free(q);
+void print_bfs_levels(b_tree_t *b_tree, void (*print_func)(void *))
+{
+    if (!b_tree || !b_tree->root)
+        return;
+
+    print_visit_t p = { print_func, 0 };
+    b_tree_bfs_core(b_tree, -1, NULL, NULL, NULL, print_levels_visit, &p);
+    printf("\n");
 }
 
 void mirror_b_tree(b_node_t *node)
@@ -827,6 +1042,52 @@ int sum_path_mod(b_node_t *node, int target, int mod, int *sum) {
     return 0;
 }
 
+// aceleași trei funcții pe arborele de int-uri, fără cast-uri din void *
+int find_node_int(int_b_node_t *node, int value)
+{
+    if (!node)
+        return 0;
+
+    if (node->data == value)
+        return 1;
+
+    return find_node_int(node->left, value) || find_node_int(node->right, value);
+}
+
+int_b_node_t *LCA_int(int_b_node_t *node, int val1, int val2)
+{
+    if (!node)
+        return NULL;
+
+    if (node->data == val1 || node->data == val2)
+        return node;
+
+    int_b_node_t *left = LCA_int(node->left, val1, val2);
+    int_b_node_t *right = LCA_int(node->right, val1, val2);
+
+    if (left && right)
+        return node;
+
+    return left ? left : right;
+}
+
+int sum_path_mod_int(int_b_node_t *node, int target, int mod, int *sum) {
+    if (!node) return 0;
+
+    int val = node->data;
+    if (val == target) {
+        if (val % mod == 0) *sum += val;
+        return 1;
+    }
+
+    if (sum_path_mod_int(node->left, target, mod, sum) || sum_path_mod_int(node->right, target, mod, sum)) {
+        if (val % mod == 0) *sum += val;
+        return 1;
+    }
+
+    return 0;
+}
+
 int main(void) {
 
     // This is a binary tree cheatsheet for SDA - Summer Exam
@@ -0,0 +1,538 @@
+/*
+ * Benchmark for list-graph.c on synthetic graphs.
+ *
+ *	gcc -O2 -pthread graph-bench.c -o graph-bench
+ *	./graph-bench [-g rmat|er|grid|chain|all] [-n nodes] [-d avg degree]
+ *		[-r repeats] [-s seed]
+ *
+ * For every graph and repeat it times ingest (lg_create + lg_add_edge per
+ * edge), BFS, DFS, shortest_path_BFS, find_strongly_connected_components,
+ * topological_sort and lg_free, and prints one JSON object per line on stdout:
+ *
+ *	{"graph":"rmat","nodes":65536,"edges":1048576,"rep":0,"op":"BFS",
+ *	 "seconds":0.05,"edges_per_sec":2.1e7,"allocs":65536,"frees":65536,
+ *	 "alloc_bytes":262144,"peak_live_bytes":1048576,"peak_rss_kb":91236}
+ *
+ * "edges" is the number of edges the operation had to look at: all of them,
+ * except for BFS / DFS where only the edges out of visited nodes count.
+ * The alloc_* / frees / peak_live_bytes fields cover only the timed call and
+ * come from wrapping malloc & co. below; peak_rss_kb is VmHWM, reset before
+ * each operation when the kernel allows it. BFS and DFS print every node, so
+ * the library's stdout goes to /dev/null and only the report is written out.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/resource.h>
+
+typedef struct
+{
+	unsigned long allocs;
+	unsigned long frees;
+	unsigned long bytes;
+	unsigned long live;
+	unsigned long peak;
+} bench_alloc_stats_t;
+
+static bench_alloc_stats_t alloc_stats;
+
+/* every block carries its size in front so that free() can account for it */
+#define BENCH_HEADER 16
+
+static void
+bench_account(size_t size)
+{
+	unsigned long live;
+
+	__atomic_add_fetch(&alloc_stats.allocs, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&alloc_stats.bytes, size, __ATOMIC_RELAXED);
+	live = __atomic_add_fetch(&alloc_stats.live, size, __ATOMIC_RELAXED);
+	if (live > __atomic_load_n(&alloc_stats.peak, __ATOMIC_RELAXED))
+		__atomic_store_n(&alloc_stats.peak, live, __ATOMIC_RELAXED);
+}
+
+static void*
+bench_malloc(size_t size)
+{
+	char* p = malloc(size + BENCH_HEADER);
+
+	if (!p)
+		return NULL;
+
+	*(size_t*)p = size;
+	bench_account(size);
+
+	return p + BENCH_HEADER;
+}
+
+static void*
+bench_calloc(size_t count, size_t size)
+{
+	void* p;
+
+	if (size && count > (size_t)-1 / size - BENCH_HEADER)
+		return NULL;
+
+	p = bench_malloc(count * size);
+	if (p)
+		memset(p, 0, count * size);
+
+	return p;
+}
+
+static void
+bench_free(void* ptr)
+{
+	char* p = ptr;
+
+	if (!p)
+		return;
+
+	p -= BENCH_HEADER;
+	__atomic_add_fetch(&alloc_stats.frees, 1, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&alloc_stats.live, *(size_t*)p, __ATOMIC_RELAXED);
+	free(p);
+}
+
+static void*
+bench_realloc(void* ptr, size_t size)
+{
+	char *p = ptr, *q;
+	size_t old;
+
+	if (!p)
+		return bench_malloc(size);
+
+	p -= BENCH_HEADER;
+	old = *(size_t*)p;
+	q = realloc(p, size + BENCH_HEADER);
+	if (!q)
+		return NULL;
+
+	*(size_t*)q = size;
+	/* a realloc counts as one allocation of the new size */
+	__atomic_add_fetch(&alloc_stats.frees, 1, __ATOMIC_RELAXED);
+	__atomic_sub_fetch(&alloc_stats.live, old, __ATOMIC_RELAXED);
+	bench_account(size);
+
+	return q + BENCH_HEADER;
+}
+
+#define malloc(size) bench_malloc(size)
+#define calloc(count, size) bench_calloc(count, size)
+#define realloc(ptr, size) bench_realloc(ptr, size)
+#define free(ptr) bench_free(ptr)
+
+#include "list-graph.c"
+
+/* enough for the recursive topological_sort on a chain of a few million nodes */
+#define BENCH_STACK_SIZE (1ul << 30)
+
+typedef struct
+{
+	const char* name;
+	int nodes;
+	unsigned int edges;
+	int* pairs;
+} bench_graph_t;
+
+typedef struct
+{
+	const char* graphs;
+	int nodes;
+	int degree;
+	int repeats;
+	unsigned long long seed;
+	FILE* out;
+} bench_opts_t;
+
+typedef struct
+{
+	struct timespec start;
+	bench_alloc_stats_t alloc;
+} bench_mark_t;
+
+/* xorshift64*, so the graphs are the same on every libc */
+static unsigned long long
+bench_rand(unsigned long long* state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+
+	return *state * 0x2545f4914f6cdd1dull;
+}
+
+static double
+bench_rand_unit(unsigned long long* state)
+{
+	return (bench_rand(state) >> 11) * (1.0 / (1ull << 53));
+}
+
+static int*
+bench_alloc_pairs(unsigned int edges)
+{
+	int* pairs = malloc((2 * (size_t)edges + 2) * sizeof(*pairs));
+	DIE(!pairs, "malloc pairs failed");
+
+	return pairs;
+}
+
+/*
+ * R-MAT with the Graph500 quadrant probabilities; the node ids are shuffled so
+ * that the hubs are not all at the start.
+ */
+static void
+bench_gen_rmat(bench_graph_t* g, int nodes, int degree, unsigned long long* rng)
+{
+	const double a = 0.57, b = 0.19, c = 0.19;
+	int scale = 0, *perm, i, j, tmp;
+	unsigned int e;
+
+	while ((1 << scale) < nodes)
+		++scale;
+
+	g->name = "rmat";
+	g->nodes = 1 << scale;
+	g->edges = (unsigned int)g->nodes * degree;
+	g->pairs = bench_alloc_pairs(g->edges);
+
+	perm = malloc(g->nodes * sizeof(*perm));
+	DIE(!perm, "malloc perm failed");
+	for (i = 0; i != g->nodes; ++i)
+		perm[i] = i;
+	for (i = g->nodes - 1; i > 0; --i) {
+		j = bench_rand(rng) % (i + 1);
+		tmp = perm[i];
+		perm[i] = perm[j];
+		perm[j] = tmp;
+	}
+
+	for (e = 0; e != g->edges; ++e) {
+		int src = 0, dest = 0, bit;
+
+		for (bit = 0; bit != scale; ++bit) {
+			double r = bench_rand_unit(rng);
+
+			src <<= 1;
+			dest <<= 1;
+			if (r < a)
+				continue;
+			if (r < a + b)
+				dest |= 1;
+			else if (r < a + b + c)
+				src |= 1;
+			else {
+				src |= 1;
+				dest |= 1;
+			}
+		}
+
+		g->pairs[2 * e] = perm[src];
+		g->pairs[2 * e + 1] = perm[dest];
+	}
+
+	free(perm);
+}
+
+/* Erdős–Rényi G(n, m): m directed edges with uniformly random endpoints */
+static void
+bench_gen_er(bench_graph_t* g, int nodes, int degree, unsigned long long* rng)
+{
+	unsigned int e;
+
+	g->name = "er";
+	g->nodes = nodes;
+	g->edges = (unsigned int)nodes * degree;
+	g->pairs = bench_alloc_pairs(g->edges);
+
+	for (e = 0; e != g->edges; ++e) {
+		g->pairs[2 * e] = bench_rand(rng) % nodes;
+		g->pairs[2 * e + 1] = bench_rand(rng) % nodes;
+	}
+}
+
+/* side x side grid, edges pointing right and down (a DAG) */
+static void
+bench_gen_grid(bench_graph_t* g, int nodes)
+{
+	int side = 1, x, y;
+	unsigned int e = 0;
+
+	while ((side + 1) * (side + 1) <= nodes)
+		++side;
+
+	g->name = "grid";
+	g->nodes = side * side;
+	g->edges = 2 * (unsigned int)side * (side - 1);
+	g->pairs = bench_alloc_pairs(g->edges);
+
+	for (y = 0; y != side; ++y) {
+		for (x = 0; x != side; ++x) {
+			int u = y * side + x;
+
+			if (x + 1 != side) {
+				g->pairs[2 * e] = u;
+				g->pairs[2 * e + 1] = u + 1;
+				++e;
+			}
+			if (y + 1 != side) {
+				g->pairs[2 * e] = u;
+				g->pairs[2 * e + 1] = u + side;
+				++e;
+			}
+		}
+	}
+}
+
+/* 0 -> 1 -> ... -> nodes - 1, the worst case for recursion depth */
+static void
+bench_gen_chain(bench_graph_t* g, int nodes)
+{
+	unsigned int e;
+
+	g->name = "chain";
+	g->nodes = nodes;
+	g->edges = nodes - 1;
+	g->pairs = bench_alloc_pairs(g->edges);
+
+	for (e = 0; e != g->edges; ++e) {
+		g->pairs[2 * e] = e;
+		g->pairs[2 * e + 1] = e + 1;
+	}
+}
+
+static long
+bench_peak_rss_kb(void)
+{
+	struct rusage usage;
+	char line[128];
+	long kb = -1;
+	FILE* f;
+
+	f = fopen("/proc/self/status", "r");
+	if (f) {
+		while (fgets(line, sizeof(line), f))
+			if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+				break;
+		fclose(f);
+	}
+	if (kb >= 0)
+		return kb;
+
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+static void
+bench_begin(bench_mark_t* mark)
+{
+	FILE* f;
+
+	/* "5" resets the peak RSS (Linux >= 4.0); ignored elsewhere */
+	f = fopen("/proc/self/clear_refs", "w");
+	if (f) {
+		fputs("5", f);
+		fclose(f);
+	}
+
+	alloc_stats.peak = alloc_stats.live;
+	mark->alloc = alloc_stats;
+	clock_gettime(CLOCK_MONOTONIC, &mark->start);
+}
+
+static void
+bench_end(bench_mark_t* mark, const bench_opts_t* opts, const bench_graph_t* g,
+	int rep, const char* op, unsigned long edges)
+{
+	struct timespec end;
+	double seconds;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	seconds = (end.tv_sec - mark->start.tv_sec)
+		+ (end.tv_nsec - mark->start.tv_nsec) * 1e-9;
+
+	fprintf(opts->out,
+		"{\"graph\":\"%s\",\"nodes\":%d,\"edges\":%lu,\"rep\":%d,"
+		"\"op\":\"%s\",\"seconds\":%.9f,\"edges_per_sec\":%.6g,"
+		"\"allocs\":%lu,\"frees\":%lu,\"alloc_bytes\":%lu,"
+		"\"peak_live_bytes\":%lu,\"peak_rss_kb\":%ld}\n",
+		g->name, g->nodes, edges, rep, op, seconds,
+		seconds > 0 ? edges / seconds : 0.0,
+		alloc_stats.allocs - mark->alloc.allocs,
+		alloc_stats.frees - mark->alloc.frees,
+		alloc_stats.bytes - mark->alloc.bytes,
+		alloc_stats.peak - mark->alloc.live,
+		bench_peak_rss_kb());
+	fflush(opts->out);
+}
+
+/* edges out of the nodes a traversal marked in color */
+static unsigned long
+bench_visited_edges(list_graph_t* graph, const int* color)
+{
+	unsigned long edges = 0;
+	int i;
+
+	for (i = 0; i != graph->nodes; ++i)
+		if (color[i])
+			edges += graph->neighbors[i]->size;
+
+	return edges;
+}
+
+static void
+bench_run_graph(const bench_opts_t* opts, const bench_graph_t* g)
+{
+	list_graph_t* graph;
+	bench_mark_t mark;
+	int *color, *component, *stack;
+	int rep, i, num_components, stack_top;
+	unsigned int e;
+	/* node 0 of a shuffled R-MAT graph may well have no out edges */
+	int start = g->edges ? g->pairs[0] : 0;
+
+	color = malloc(g->nodes * sizeof(*color));
+	component = malloc(g->nodes * sizeof(*component));
+	stack = malloc(g->nodes * sizeof(*stack));
+	DIE(!color || !component || !stack, "malloc bench buffers failed");
+
+	for (rep = 0; rep != opts->repeats; ++rep) {
+		bench_begin(&mark);
+		graph = lg_create(g->nodes);
+		for (e = 0; e != g->edges; ++e)
+			lg_add_edge(graph, g->pairs[2 * e], g->pairs[2 * e + 1]);
+		bench_end(&mark, opts, g, rep, "ingest", g->edges);
+
+		memset(color, 0, g->nodes * sizeof(*color));
+		bench_begin(&mark);
+		BFS(graph, start, color);
+		bench_end(&mark, opts, g, rep, "BFS", bench_visited_edges(graph, color));
+
+		memset(color, 0, g->nodes * sizeof(*color));
+		bench_begin(&mark);
+		DFS(graph, start, color);
+		bench_end(&mark, opts, g, rep, "DFS", bench_visited_edges(graph, color));
+
+		bench_begin(&mark);
+		shortest_path_BFS(graph, start, g->nodes - 1);
+		bench_end(&mark, opts, g, rep, "shortest_path_BFS", g->edges);
+
+		bench_begin(&mark);
+		find_strongly_connected_components(graph, component, &num_components);
+		bench_end(&mark, opts, g, rep, "find_strongly_connected_components",
+			g->edges);
+
+		memset(color, 0, g->nodes * sizeof(*color));
+		stack_top = 0;
+		bench_begin(&mark);
+		for (i = 0; i != g->nodes; ++i)
+			if (!color[i])
+				topological_sort(graph, color, stack, &stack_top, i);
+		bench_end(&mark, opts, g, rep, "topological_sort", g->edges);
+
+		bench_begin(&mark);
+		lg_free(graph);
+		bench_end(&mark, opts, g, rep, "lg_free", g->edges);
+	}
+
+	free(stack);
+	free(component);
+	free(color);
+}
+
+static void*
+bench_main(void* arg)
+{
+	const bench_opts_t* opts = arg;
+	unsigned long long rng = opts->seed ? opts->seed : 1;
+	const char* kinds[] = { "rmat", "er", "grid", "chain" };
+	bench_graph_t g;
+	unsigned int k;
+
+	for (k = 0; k != sizeof(kinds) / sizeof(*kinds); ++k) {
+		if (strcmp(opts->graphs, "all") && strcmp(opts->graphs, kinds[k]))
+			continue;
+
+		if (k == 0)
+			bench_gen_rmat(&g, opts->nodes, opts->degree, &rng);
+		else if (k == 1)
+			bench_gen_er(&g, opts->nodes, opts->degree, &rng);
+		else if (k == 2)
+			bench_gen_grid(&g, opts->nodes);
+		else
+			bench_gen_chain(&g, opts->nodes);
+
+		bench_run_graph(opts, &g);
+		free(g.pairs);
+	}
+
+	lg_trav_local_free();
+	return NULL;
+}
+
+static void
+bench_usage(const char* prog)
+{
+	fprintf(stderr,
+		"usage: %s [-g rmat|er|grid|chain|all] [-n nodes] [-d avg degree]"
+		" [-r repeats] [-s seed]\n", prog);
+	exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char* argv[])
+{
+	bench_opts_t opts = { "all", 1 << 16, 8, 1, 42, NULL };
+	pthread_attr_t attr;
+	pthread_t tid;
+	int fd, opt;
+
+	while ((opt = getopt(argc, argv, "g:n:d:r:s:")) != -1) {
+		switch (opt) {
+		case 'g':
+			opts.graphs = optarg;
+			break;
+		case 'n':
+			opts.nodes = atoi(optarg);
+			break;
+		case 'd':
+			opts.degree = atoi(optarg);
+			break;
+		case 'r':
+			opts.repeats = atoi(optarg);
+			break;
+		case 's':
+			opts.seed = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			bench_usage(argv[0]);
+		}
+	}
+
+	if (opts.nodes < 2 || opts.degree < 1 || opts.repeats < 1)
+		bench_usage(argv[0]);
+
+	/* the report keeps the real stdout, the traversals print to /dev/null */
+	fd = dup(STDOUT_FILENO);
+	DIE(fd < 0, "dup stdout");
+	opts.out = fdopen(fd, "w");
+	DIE(!opts.out, "fdopen");
+	DIE(!freopen("/dev/null", "w", stdout), "freopen /dev/null");
+
+	/* the recursive cheat-sheet functions need a deep stack on long chains */
+	pthread_attr_init(&attr);
+	DIE(pthread_attr_setstacksize(&attr, BENCH_STACK_SIZE), "setstacksize");
+	DIE(pthread_create(&tid, &attr, bench_main, &opts), "pthread_create");
+	pthread_join(tid, NULL);
+	pthread_attr_destroy(&attr);
+
+	fclose(opts.out);
+	return 0;
+}
@@ -1,8 +1,18 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #define MIN(x, y) ((x) < (y) ? (x) : (y))
 
@@ -19,10 +29,19 @@
     } while (0)
 
 typedef struct ll_node_t ll_node_t;
+typedef struct ll_slab_t ll_slab_t;
+typedef struct ll_arena_t ll_arena_t;
 typedef struct linked_list_t linked_list_t;
+typedef struct lg_ring_t lg_ring_t;
+typedef struct lg_vec_t lg_vec_t;
 typedef struct stack_t stack_t;
 typedef struct queue_t queue_t;
+typedef struct lg_edge_index_t lg_edge_index_t;
+typedef struct lg_components_t lg_components_t;
+typedef struct lg_wedge_t lg_wedge_t;
 typedef struct list_graph_t list_graph_t;
+typedef struct csr_graph_t csr_graph_t;
+typedef struct vcsr_graph_t vcsr_graph_t;
 
 /* Helper data structures definitions */
 struct ll_node_t
@@ -31,18 +50,75 @@ struct ll_node_t
 	ll_node_t* next;
 };
 
+/*
+ * Slab allocator for list nodes. Every node handed out by an arena is followed
+ * by data_size bytes of inline payload (node->data points right after the
+ * node), so adding an element costs a pointer bump instead of two mallocs.
+ * Removed nodes go on a free list; ll_arena_free() drops all slabs at once.
+ */
+struct ll_slab_t
+{
+	ll_slab_t* next;
+};
+
+struct ll_arena_t
+{
+	ll_slab_t* slabs;
+	ll_node_t* free_nodes;
+	char* cursor;
+	char* end;
+	unsigned int data_size;
+	unsigned int node_size;
+	unsigned int slab_nodes;
+};
+
 struct linked_list_t
 {
 	ll_node_t* head;
 	unsigned int data_size;
 	unsigned int size;
+	ll_arena_t* arena;
+};
+
+/*
+ * Inline element storage shared by the array modes of stack_t / queue_t and the
+ * typed containers. Neither stores its element size; see lg_ring_init().
+ * A ring has mask + 1 slots (a power of two) and its elements run from head,
+ * wrapping; a vec keeps them in items[0] ... items[size - 1].
+ */
+struct lg_ring_t
+{
+	unsigned char* buf;
+	unsigned int mask;
+	unsigned int head;
+	unsigned int size;
+};
+
+struct lg_vec_t
+{
+	unsigned char* items;
+	unsigned int size;
+	unsigned int cap;
 };
 
+/*
+ * st_create() stacks are a linked list with the top at its head.
+ * st_create_array() stacks have list == NULL and keep the elements inline in
+ * vec (data_size bytes each, top at the end), doubling it when full.
+ */
 struct stack_t
 {
 	struct linked_list_t* list;
+	lg_vec_t vec;
+	unsigned int data_size;
 };
 
+/*
+ * A queue made by q_create() holds max_size pointers to malloc'd copies and
+ * refuses elements once full. One made by q_create_ring() keeps the elements
+ * themselves in ring (data_size bytes each) and doubles instead of refusing;
+ * buff is NULL and only data_size and ring are used.
+ */
 struct queue_t
 {
 	unsigned int max_size;
@@ -51,14 +127,237 @@ struct queue_t
 	unsigned int read_idx;
 	unsigned int write_idx;
 	void **buff;
+	lg_ring_t ring;
+};
+
+/*
+ * Open-addressing (linear probing) hash table mapping an edge (src, dest) to
+ * the list node that stores it. A slot is empty when its node is NULL. Parallel
+ * edges get one entry each.
+ */
+struct lg_edge_index_t
+{
+	unsigned long long* keys;
+	ll_node_t** nodes;
+	unsigned int capacity;
+	unsigned int size;
+};
+
+/*
+ * Union-find over the edges of a graph, ignoring their direction. The smaller
+ * root always wins a union, so every root is the smallest node of its
+ * component. Removing an edge can split a component, which union-find cannot
+ * undo, so lg_remove_edge only sets dirty and the next query rebuilds.
+ */
+struct lg_components_t
+{
+	int* parent;
+	int dirty;
+};
+
+/*
+ * List payload of a weighted graph. dest comes first, so *(int*)node->data is
+ * the neighbour in weighted and unweighted graphs alike.
+ */
+struct lg_wedge_t
+{
+	int dest;
+	int weight;
 };
 
 struct list_graph_t
 {
 	linked_list_t** neighbors;
 	int nodes;
+	int weighted;
+	ll_arena_t* arena;
+	lg_edge_index_t* index;
+	lg_components_t* components;
+};
+
+/*
+ * Immutable compressed-sparse-row copy of a list_graph_t. The neighbours of
+ * node u are adj[offsets[u]] ... adj[offsets[u + 1] - 1], in the same order as
+ * in the linked list they were frozen from. weights is parallel to adj when the
+ * graph is weighted and NULL otherwise (every edge then weighs 1).
+ */
+struct csr_graph_t
+{
+	unsigned int* offsets;
+	int* adj;
+	int* weights;
+	int nodes;
+	unsigned int edges;
+	/* set by csr_map(): the arrays point into this read-only mapping */
+	void* map;
+	unsigned long map_size;
+};
+
+/*
+ * Read-only compressed adjacency. The neighbours of u are sorted and stored in
+ * data[offsets[u]] ... data[offsets[u + 1] - 1] as LEB128 varints: the first
+ * one as the zigzag-encoded difference from u, the others as the gap from the
+ * previous neighbour. data has VCSR_PADDING spare bytes at the end so the
+ * decoder can always read a whole word.
+ */
+struct vcsr_graph_t
+{
+	unsigned long* offsets;
+	unsigned char* data;
+	int nodes;
+	unsigned int edges;
+	unsigned int max_degree;
 };
 
+/*
+ * Traversal counters, compiled in only with -DLG_STATS; otherwise the LG_STAT_*
+ * macros expand to nothing. They are per thread: lg_stats_get() returns the
+ * counters of the calling thread since its last lg_stats_reset().
+ */
+#ifdef LG_STATS
+#include <time.h>
+
+typedef struct
+{
+	unsigned long edges_scanned;
+	unsigned long nodes_dequeued;	/* from queues and stacks */
+	unsigned long queue_high_water;
+	unsigned long mallocs;		/* list nodes, slabs and queue elements */
+	unsigned long frees;
+	unsigned long levels;		/* BFS levels completed */
+	unsigned long long level_ns;	/* time spent in those levels */
+} lg_stats_t;
+
+/* called at the end of every BFS level with its size and duration */
+typedef void (*lg_level_hook_t)(int level, unsigned long nodes,
+	unsigned long long ns, void* arg);
+
+static __thread lg_stats_t lg_stats;
+static __thread lg_level_hook_t lg_level_hook;
+static __thread void* lg_level_hook_arg;
+
+lg_stats_t*
+lg_stats_get(void)
+{
+	return &lg_stats;
+}
+
+void
+lg_stats_reset(void)
+{
+	memset(&lg_stats, 0, sizeof(lg_stats));
+}
+
+void
+lg_stats_set_level_hook(lg_level_hook_t hook, void* arg)
+{
+	lg_level_hook = hook;
+	lg_level_hook_arg = arg;
+}
+
+static inline unsigned long long
+lg_stats_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static inline void
+lg_stats_level_end(int level, unsigned long nodes, unsigned long long start)
+{
+	unsigned long long ns = lg_stats_now() - start;
+
+	++lg_stats.levels;
+	lg_stats.level_ns += ns;
+	if (lg_level_hook)
+		lg_level_hook(level, nodes, ns, lg_level_hook_arg);
+}
+
+#define LG_STAT_ADD(field, n) (lg_stats.field += (n))
+#define LG_STAT_MAX(field, v) \
+	(lg_stats.field < (v) ? (void)(lg_stats.field = (v)) : (void)0)
+#define LG_STAT_LEVEL_BEGIN(t) unsigned long long t = lg_stats_now()
+#define LG_STAT_LEVEL_END(t, level, nodes) lg_stats_level_end(level, nodes, t)
+#else
+#define LG_STAT_ADD(field, n) ((void)0)
+#define LG_STAT_MAX(field, v) ((void)0)
+#define LG_STAT_LEVEL_BEGIN(t) ((void)0)
+#define LG_STAT_LEVEL_END(t, level, nodes) ((void)0)
+#endif
+
+#define LL_SLAB_MAX_NODES (1u << 16)
+
+ll_arena_t*
+ll_arena_create(unsigned int data_size, unsigned int slab_nodes)
+{
+	ll_arena_t* arena = calloc(1, sizeof(*arena));
+	DIE(!arena, "calloc arena");
+
+	arena->data_size = data_size;
+	arena->node_size = sizeof(ll_node_t) + data_size;
+	arena->node_size = (arena->node_size + sizeof(void*) - 1)
+		& ~(unsigned int)(sizeof(void*) - 1);
+	/* growth stops at LL_SLAB_MAX_NODES, so the first slab does too */
+	arena->slab_nodes = slab_nodes ? MIN(slab_nodes, LL_SLAB_MAX_NODES) : 64;
+
+	return arena;
+}
+
+static ll_node_t*
+ll_arena_alloc(ll_arena_t* arena)
+{
+	ll_slab_t* slab;
+	ll_node_t* node;
+
+	if (arena->free_nodes) {
+		node = arena->free_nodes;
+		arena->free_nodes = node->next;
+		return node;
+	}
+
+	if (arena->cursor == arena->end) {
+		slab = malloc(sizeof(*slab)
+			+ (size_t)arena->slab_nodes * arena->node_size);
+		DIE(!slab, "malloc slab");
+		LG_STAT_ADD(mallocs, 1);
+
+		slab->next = arena->slabs;
+		arena->slabs = slab;
+		arena->cursor = (char*)(slab + 1);
+		arena->end = arena->cursor
+			+ (size_t)arena->slab_nodes * arena->node_size;
+
+		/* geometric growth keeps the number of slabs logarithmic */
+		if (arena->slab_nodes < LL_SLAB_MAX_NODES)
+			arena->slab_nodes *= 2;
+	}
+
+	node = (ll_node_t*)arena->cursor;
+	arena->cursor += arena->node_size;
+
+	return node;
+}
+
+void
+ll_arena_free(ll_arena_t* arena)
+{
+	ll_slab_t* slab;
+
+	if (!arena)
+		return;
+
+	while (arena->slabs) {
+		slab = arena->slabs;
+		arena->slabs = slab->next;
+		free(slab);
+		LG_STAT_ADD(frees, 1);
+	}
+
+	free(arena);
+}
+
 linked_list_t*
 ll_create(unsigned int data_size)
 {
@@ -70,6 +369,19 @@ ll_create(unsigned int data_size)
 	return ll;
 }
 
+linked_list_t*
+ll_create_in(unsigned int data_size, ll_arena_t* arena)
+{
+	linked_list_t* ll;
+
+	DIE(arena && arena->data_size != data_size, "arena data size mismatch");
+
+	ll = ll_create(data_size);
+	ll->arena = arena;
+
+	return ll;
+}
+
 static ll_node_t*
 get_nth_node(linked_list_t* list, unsigned int n)
 {
@@ -86,19 +398,46 @@ get_nth_node(linked_list_t* list, unsigned int n)
 }
 
 static ll_node_t*
-create_node(const void* new_data, unsigned int data_size)
+create_node(linked_list_t* list, const void* new_data)
 {
-	ll_node_t* node = calloc(1, sizeof(*node));
-	DIE(!node, "calloc node");
+	ll_node_t* node;
+
+	if (list->arena) {
+		node = ll_arena_alloc(list->arena);
+		node->next = NULL;
+		node->data = node + 1;
+	} else {
+		node = calloc(1, sizeof(*node));
+		DIE(!node, "calloc node");
 
-	node->data = malloc(data_size);
-	DIE(!node->data, "malloc data");
+		node->data = malloc(list->data_size);
+		DIE(!node->data, "malloc data");
+		LG_STAT_ADD(mallocs, 2);
+	}
 
-	memcpy(node->data, new_data, data_size);
+	memcpy(node->data, new_data, list->data_size);
 
 	return node;
 }
 
+/* Releases a node returned by ll_remove_nth_node() from the same list. */
+void
+ll_free_node(linked_list_t* list, ll_node_t* node)
+{
+	if (!node)
+		return;
+
+	if (list && list->arena) {
+		node->next = list->arena->free_nodes;
+		list->arena->free_nodes = node;
+		return;
+	}
+
+	free(node->data);
+	free(node);
+	LG_STAT_ADD(frees, 2);
+}
+
 void
 ll_add_nth_node(linked_list_t* list, unsigned int n, const void* new_data)
 {
@@ -107,7 +446,7 @@ ll_add_nth_node(linked_list_t* list, unsigned int n, const void* new_data)
 	if (!list)
 		return;
 
-	new_node = create_node(new_data, list->data_size);
+	new_node = create_node(list, new_data);
 
 	if (!n || !list->size) {
 		new_node->next = list->head;
@@ -161,8 +500,7 @@ ll_free(linked_list_t** pp_list)
 
 	while ((*pp_list)->size) {
 		node = ll_remove_nth_node(*pp_list, 0);
-		free(node->data);
-		free(node);
+		ll_free_node(*pp_list, node);
 	}
 
 	free(*pp_list);
@@ -189,13 +527,171 @@ ll_print_string(linked_list_t* list)
 	printf("\n");
 }
 
+/*
+ * Untyped cores of the inline containers: a power-of-two ring and a growable
+ * array of fixed-size elements, stored back to back. The element size is an
+ * argument rather than a field, so the typed containers (LG_DEFINE_QUEUE /
+ * STACK) pass sizeof(T) and every copy inlines to a fixed-size move, while
+ * q_create_ring() and st_create_array() pass their data_size.
+ */
+static inline void
+lg_ring_init(lg_ring_t* r, unsigned int stride, unsigned int capacity)
+{
+	unsigned int cap = 16;
+
+	while (cap < capacity)
+		cap *= 2;
+	r->buf = malloc((size_t)cap * stride);
+	DIE(!r->buf, "malloc ring failed");
+	LG_STAT_ADD(mallocs, 1);
+	r->mask = cap - 1;
+	r->head = r->size = 0;
+}
+
+static void
+lg_ring_grow(lg_ring_t* r, unsigned int stride)
+{
+	unsigned int cap = 2 * (r->mask + 1);
+	unsigned int first = r->mask + 1 - r->head;
+	unsigned char* buf = malloc((size_t)cap * stride);
+	DIE(!buf, "malloc ring failed");
+	LG_STAT_ADD(mallocs, 1);
+
+	/* the ring is full, so it runs from head to the end, then wraps */
+	memcpy(buf, r->buf + (size_t)r->head * stride, (size_t)first * stride);
+	memcpy(buf + (size_t)first * stride, r->buf, (size_t)r->head * stride);
+
+	free(r->buf);
+	LG_STAT_ADD(frees, 1);
+	r->buf = buf;
+	r->head = 0;
+	r->mask = cap - 1;
+}
+
+/* slot for a new element at the back, doubling the ring when it is full */
+static inline void*
+lg_ring_push(lg_ring_t* r, unsigned int stride)
+{
+	void* slot;
+
+	if (r->size == r->mask + 1)
+		lg_ring_grow(r, stride);
+	slot = r->buf + (size_t)((r->head + r->size) & r->mask) * stride;
+	++r->size;
+	LG_STAT_MAX(queue_high_water, r->size);
+	return slot;
+}
+
+/* the ring must not be empty */
+static inline void*
+lg_ring_front(const lg_ring_t* r, unsigned int stride)
+{
+	return r->buf + (size_t)r->head * stride;
+}
+
+static inline void
+lg_ring_pop(lg_ring_t* r)
+{
+	r->head = (r->head + 1) & r->mask;
+	--r->size;
+}
+
+static inline void
+lg_ring_destroy(lg_ring_t* r)
+{
+	free(r->buf);
+	LG_STAT_ADD(frees, 1);
+	r->buf = NULL;
+	r->mask = r->head = r->size = 0;
+}
+
+static inline void
+lg_vec_init(lg_vec_t* v, unsigned int stride, unsigned int capacity)
+{
+	v->cap = capacity ? capacity : 16;
+	v->items = malloc((size_t)v->cap * stride);
+	DIE(!v->items, "malloc items failed");
+	LG_STAT_ADD(mallocs, 1);
+	v->size = 0;
+}
+
+static void
+lg_vec_grow(lg_vec_t* v, unsigned int stride, unsigned int extra)
+{
+	while (v->cap < v->size + extra)
+		v->cap *= 2;
+	v->items = realloc(v->items, (size_t)v->cap * stride);
+	DIE(!v->items, "realloc items failed");
+	/* realloc releases the old block */
+	LG_STAT_ADD(mallocs, 1);
+	LG_STAT_ADD(frees, 1);
+}
+
+static inline void
+lg_vec_reserve(lg_vec_t* v, unsigned int stride, unsigned int extra)
+{
+	if (v->size + extra > v->cap)
+		lg_vec_grow(v, stride, extra);
+}
+
+/* slot for a new element on top */
+static inline void*
+lg_vec_push(lg_vec_t* v, unsigned int stride)
+{
+	if (v->size == v->cap)
+		lg_vec_grow(v, stride, 1);
+	return v->items + (size_t)v->size++ * stride;
+}
+
+/* appends count elements from data in one copy */
+static inline void
+lg_vec_push_range(lg_vec_t* v, unsigned int stride, const void* data,
+	unsigned int count)
+{
+	lg_vec_reserve(v, stride, count);
+	memcpy(v->items + (size_t)v->size * stride, data, (size_t)count * stride);
+	v->size += count;
+}
+
+static inline void*
+lg_vec_top(const lg_vec_t* v, unsigned int stride)
+{
+	return v->size ? v->items + (size_t)(v->size - 1) * stride : NULL;
+}
+
+static inline void
+lg_vec_destroy(lg_vec_t* v)
+{
+	free(v->items);
+	LG_STAT_ADD(frees, 1);
+	v->items = NULL;
+	v->size = v->cap = 0;
+}
+
 stack_t*
 st_create(unsigned int data_size)
 {
-	stack_t* st = malloc(sizeof(*st));
-	DIE(!st, "malloc st failed");
+	stack_t* st = calloc(1, sizeof(*st));
+	DIE(!st, "calloc st failed");
 	st->list = ll_create(data_size);
 	DIE(!st->list, "malloc list failed");
+	st->data_size = data_size;
+
+	return st;
+}
+
+/*
+ * Array-backed stack: a push is a copy into vec, a pop a decrement. The
+ * pointer returned by st_peek() is valid until the next push.
+ */
+stack_t*
+st_create_array(unsigned int data_size, unsigned int capacity)
+{
+	stack_t* st = calloc(1, sizeof(*st));
+	DIE(!st, "calloc st failed");
+
+	st->data_size = data_size;
+	lg_vec_init(&st->vec, data_size, capacity);
 
 	return st;
 }
@@ -203,7 +699,11 @@ st_create(unsigned int data_size)
 unsigned int
 st_get_size(stack_t* st)
 {
-	if (!st || !st->list)
+	if (!st)
+		return 0;
+	if (st->vec.items)
+		return st->vec.size;
+	if (!st->list)
 		return 0;
 	return st->list->size;
 }
@@ -211,12 +711,15 @@ st_get_size(stack_t* st)
 unsigned int
 st_is_empty(stack_t* st)
 {
-	return !st || !st->list || !st->list->size;
+	return !st_get_size(st);
 }
 
 void*
 st_peek(stack_t* st)
 {
+	if (st && st->vec.items)
+		return lg_vec_top(&st->vec, st->data_size);
+
 	if (!st || !st->list || !st->list->size)
 		return NULL;
 
@@ -228,26 +731,64 @@ st_pop(stack_t* st)
 {
 	ll_node_t *node;
 
+	if (st && st->vec.items) {
+		if (st->vec.size)
+			--st->vec.size;
+		return;
+	}
+
 	if (!st || !st->list)
 		return;
 
 	node = ll_remove_nth_node(st->list, 0);
-	free(node->data);
-	free(node);
+	ll_free_node(st->list, node);
 }
 
 void
 st_push(stack_t* st, void* new_data)
 {
+	if (st && st->vec.items) {
+		memcpy(lg_vec_push(&st->vec, st->data_size), new_data,
+			st->data_size);
+		return;
+	}
+
     if (!st || !st->list)
         return;
     
     ll_add_nth_node(st->list, 0, new_data);
 }
 
+/*
+ * Pushes count contiguous elements in order, so data[count - 1] ends up on
+ * top. On an array stack this is a single memcpy.
+ */
+void
+st_push_range(stack_t* st, const void* data, unsigned int count)
+{
+	const unsigned char* src = data;
+	unsigned int i;
+
+	if (!st || !count)
+		return;
+
+	if (st->vec.items) {
+		lg_vec_push_range(&st->vec, st->data_size, data, count);
+		return;
+	}
+
+	for (i = 0; i != count; ++i)
+		st_push(st, (void*)(src + (size_t)i * st->data_size));
+}
+
 void
 st_clear(stack_t* st)
 {
+	if (st && st->vec.items) {
+		st->vec.size = 0;
+		return;
+	}
+
 	if (!st || !st->list)
 		return;
 
@@ -257,6 +798,12 @@ st_clear(stack_t* st)
 void
 st_free(stack_t* st)
 {
+	if (st && st->vec.items) {
+		lg_vec_destroy(&st->vec);
+		free(st);
+		return;
+	}
+
 	if (!st || !st->list)
 		return;
 
@@ -279,21 +826,44 @@ q_create(unsigned int data_size, unsigned int max_size)
 	return q;
 }
 
+/*
+ * Inline, growable queue (see struct queue_t). capacity is only the initial
+ * size. The pointer returned by q_front() is valid until the next enqueue, so
+ * copy the element out before enqueueing more.
+ */
+queue_t *
+q_create_ring(unsigned int data_size, unsigned int capacity)
+{
+	queue_t *q = calloc(1, sizeof(*q));
+	DIE(!q, "calloc queue failed");
+
+	q->data_size = data_size;
+	lg_ring_init(&q->ring, data_size, capacity);
+
+	return q;
+}
+
 unsigned int
 q_get_size(queue_t *q)
 {
+	if (q && q->ring.buf)
+		return q->ring.size;
 	return !q ? 0 : q->size;
 }
 
 unsigned int
 q_is_empty(queue_t *q)
 {
-	return !q ? 1 : !q->size;
+	return !q_get_size(q);
 }
 
 void *
 q_front(queue_t *q)
 {
+	if (q && q->ring.buf)
+		return q->ring.size
+			? lg_ring_front(&q->ring, q->data_size) : NULL;
+
 	if (!q || !q->size)
 		return NULL;
 
@@ -303,10 +873,18 @@ q_front(queue_t *q)
 int
 q_dequeue(queue_t *q)
 {
+	if (q && q->ring.buf) {
+		if (!q->ring.size)
+			return 0;
+		lg_ring_pop(&q->ring);
+		return 1;
+	}
+
 	if (!q || !q->size)
 		return 0;
 
 	free(q->buff[q->read_idx]);
+	LG_STAT_ADD(frees, 1);
 
 	q->read_idx = (q->read_idx + 1) % q->max_size;
 	--q->size;
@@ -317,16 +895,25 @@ int
 q_enqueue(queue_t *q, void *new_data)
 {
 	void *data;
+
+	if (q && q->ring.buf) {
+		memcpy(lg_ring_push(&q->ring, q->data_size), new_data,
+			q->data_size);
+		return 1;
+	}
+
 	if (!q || q->size == q->max_size)
 		return 0;
 
 	data = malloc(q->data_size);
 	DIE(!data, "malloc data failed");
+	LG_STAT_ADD(mallocs, 1);
 	memcpy(data, new_data, q->data_size);
 
 	q->buff[q->write_idx] = data;
 	q->write_idx = (q->write_idx + 1) % q->max_size;
 	++q->size;
+	LG_STAT_MAX(queue_high_water, q->size);
 
 	return 1;
 }
@@ -335,11 +922,20 @@ void
 q_clear(queue_t *q)
 {
 	unsigned int i;
+
+	/* the ring owns no per-element memory */
+	if (q && q->ring.buf) {
+		q->ring.head = q->ring.size = 0;
+		return;
+	}
+
 	if (!q || !q->size)
 		return;
 
-	for (i = q->read_idx; i != q->write_idx; i = (i + 1) % q->max_size)
+	for (i = q->read_idx; i != q->write_idx; i = (i + 1) % q->max_size) {
 		free(q->buff[i]);
+		LG_STAT_ADD(frees, 1);
+	}
 
 	q->read_idx = 0;
 	q->write_idx = 0;
@@ -354,68 +950,638 @@ q_free(queue_t *q)
 
 	q_clear(q);
 	free(q->buff);
+	if (q->ring.buf)
+		lg_ring_destroy(&q->ring);
 	free(q);
 }
 
 
+/*
+ * Typed containers. LG_DEFINE_LIST / QUEUE / STACK(name, T) generate a
+ * container of T stored by value, so element copies are plain assignments
+ * instead of memcpy of data_size bytes, and queues / stacks hold their elements
+ * in one buffer instead of boxing each one. The queue and stack structs live
+ * wherever the caller puts them (init / destroy instead of create / free).
+ * Queues and stacks share lg_ring_t / lg_vec_t with q_create_ring() and
+ * st_create_array(), which remain the void * API for runtime-sized data.
+ * int_list_t, int_queue_t and int_stack_t are instantiated below.
+ */
+#define LG_DEFINE_LIST(name, T)						\
+typedef struct name##_list_node_t name##_list_node_t;			\
+struct name##_list_node_t						\
+{									\
+	name##_list_node_t* next;					\
+	T data;								\
+};									\
+									\
+typedef struct								\
+{									\
+	name##_list_node_t* head;					\
+	unsigned int size;						\
+} name##_list_t;							\
+									\
+static inline void							\
+name##_list_init(name##_list_t* list)					\
+{									\
+	list->head = NULL;						\
+	list->size = 0;							\
+}									\
+									\
+/* n >= size appends */							\
+static inline void							\
+name##_list_add_nth(name##_list_t* list, unsigned int n, T data)	\
+{									\
+	name##_list_node_t** link = &list->head;			\
+	name##_list_node_t* node = malloc(sizeof(*node));		\
+	DIE(!node, "malloc node");					\
+	LG_STAT_ADD(mallocs, 1);					\
+									\
+	for (; *link && n; --n)						\
+		link = &(*link)->next;					\
+	node->data = data;						\
+	node->next = *link;						\
+	*link = node;							\
+	++list->size;							\
+}									\
+									\
+/* n >= size removes the last element; returns 0 if the list is empty */ \
+static inline int							\
+name##_list_remove_nth(name##_list_t* list, unsigned int n, T* data)	\
+{									\
+	name##_list_node_t** link = &list->head;			\
+	name##_list_node_t* node;					\
+									\
+	if (!list->head)						\
+		return 0;						\
+	for (; (*link)->next && n; --n)					\
+		link = &(*link)->next;					\
+	node = *link;							\
+	*link = node->next;						\
+	if (data)							\
+		*data = node->data;					\
+	free(node);							\
+	LG_STAT_ADD(frees, 1);						\
+	--list->size;							\
+	return 1;							\
+}									\
+									\
+static inline T*							\
+name##_list_get_nth(name##_list_t* list, unsigned int n)		\
+{									\
+	name##_list_node_t* node = list->head;				\
+									\
+	if (!node)							\
+		return NULL;						\
+	for (; node->next && n; --n)					\
+		node = node->next;					\
+	return &node->data;						\
+}									\
+									\
+static inline void							\
+name##_list_destroy(name##_list_t* list)				\
+{									\
+	name##_list_node_t* node;					\
+									\
+	while ((node = list->head)) {					\
+		list->head = node->next;				\
+		free(node);						\
+		LG_STAT_ADD(frees, 1);					\
+	}								\
+	list->size = 0;							\
+}
+
+/* power-of-two ring of T that doubles when full, over lg_ring_t */
+#define LG_DEFINE_QUEUE(name, T)					\
+typedef struct								\
+{									\
+	lg_ring_t r;							\
+} name##_queue_t;							\
+									\
+static inline void							\
+name##_queue_init(name##_queue_t* q, unsigned int capacity)		\
+{									\
+	lg_ring_init(&q->r, sizeof(T), capacity);			\
+}									\
+									\
+static inline void							\
+name##_queue_push(name##_queue_t* q, T x)				\
+{									\
+	*(T*)lg_ring_push(&q->r, sizeof(T)) = x;			\
+}									\
+									\
+/* the queue must not be empty */					\
+static inline T								\
+name##_queue_pop(name##_queue_t* q)					\
+{									\
+	T x = *(T*)lg_ring_front(&q->r, sizeof(T));			\
+									\
+	lg_ring_pop(&q->r);						\
+	return x;							\
+}									\
+									\
+static inline unsigned int						\
+name##_queue_size(const name##_queue_t* q)				\
+{									\
+	return q->r.size;						\
+}									\
+									\
+static inline int							\
+name##_queue_is_empty(const name##_queue_t* q)				\
+{									\
+	return !q->r.size;						\
+}									\
+									\
+static inline void							\
+name##_queue_clear(name##_queue_t* q)					\
+{									\
+	q->r.head = q->r.size = 0;					\
+}									\
+									\
+static inline void							\
+name##_queue_destroy(name##_queue_t* q)					\
+{									\
+	lg_ring_destroy(&q->r);						\
+}
+
+/* growable array of T, top at the end, over lg_vec_t */
+#define LG_DEFINE_STACK(name, T)					\
+typedef struct								\
+{									\
+	lg_vec_t v;							\
+} name##_stack_t;							\
+									\
+static inline void							\
+name##_stack_init(name##_stack_t* st, unsigned int capacity)		\
+{									\
+	lg_vec_init(&st->v, sizeof(T), capacity);			\
+}									\
+									\
+static inline void							\
+name##_stack_reserve(name##_stack_t* st, unsigned int extra)		\
+{									\
+	lg_vec_reserve(&st->v, sizeof(T), extra);			\
+}									\
+									\
+static inline void							\
+name##_stack_push(name##_stack_t* st, T x)				\
+{									\
+	*(T*)lg_vec_push(&st->v, sizeof(T)) = x;			\
+}									\
+									\
+/* pushes data[0 .. count - 1], data[count - 1] ends up on top */	\
+static inline void							\
+name##_stack_push_range(name##_stack_t* st, const T* data,		\
+	unsigned int count)						\
+{									\
+	lg_vec_push_range(&st->v, sizeof(T), data, count);		\
+}									\
+									\
+/* the stack must not be empty */					\
+static inline T								\
+name##_stack_pop(name##_stack_t* st)					\
+{									\
+	return ((T*)st->v.items)[--st->v.size];				\
+}									\
+									\
+static inline T*							\
+name##_stack_peek(name##_stack_t* st)					\
+{									\
+	return lg_vec_top(&st->v, sizeof(T));				\
+}									\
+									\
+static inline unsigned int						\
+name##_stack_size(const name##_stack_t* st)				\
+{									\
+	return st->v.size;						\
+}									\
+									\
+static inline int							\
+name##_stack_is_empty(const name##_stack_t* st)				\
+{									\
+	return !st->v.size;						\
+}									\
+									\
+static inline void							\
+name##_stack_destroy(name##_stack_t* st)				\
+{									\
+	lg_vec_destroy(&st->v);						\
+}
+
+LG_DEFINE_LIST(int, int)
+LG_DEFINE_QUEUE(int, int)
+LG_DEFINE_STACK(int, int)
+
 static int is_node_in_graph(int n, int nodes)
 {
 	return n >= 0 && n < nodes;
 }
 
-list_graph_t*
-lg_create(int nodes)
+#define LG_INDEX_MIN_CAPACITY 64
+
+static unsigned long long
+edge_key(int src, int dest)
 {
-	int i;
+	return (unsigned long long)(unsigned int)src << 32 | (unsigned int)dest;
+}
 
-	list_graph_t *g = malloc(sizeof(*g));
-	DIE(!g, "malloc graph failed");
+static unsigned int
+edge_slot(lg_edge_index_t* index, unsigned long long key)
+{
+	/* Fibonacci hashing, capacity is a power of two */
+	return (unsigned int)((key * 0x9E3779B97F4A7C15ull) >> 32)
+		& (index->capacity - 1);
+}
 
-	g->neighbors = malloc(nodes * sizeof(*g->neighbors));
-	DIE(!g->neighbors, "malloc neighbours failed");
+static void
+edge_index_alloc(lg_edge_index_t* index, unsigned int capacity)
+{
+	index->capacity = capacity;
+	index->size = 0;
+	index->keys = malloc(capacity * sizeof(*index->keys));
+	index->nodes = calloc(capacity, sizeof(*index->nodes));
+	DIE(!index->keys || !index->nodes, "malloc edge index failed");
+}
 
-	for (i = 0; i != nodes; ++i)
-		g->neighbors[i] = ll_create(sizeof(int));
+static void
+edge_index_insert(lg_edge_index_t* index, unsigned long long key, ll_node_t* node);
 
-	g->nodes = nodes;
+static void
+edge_index_grow(lg_edge_index_t* index)
+{
+	unsigned long long* keys = index->keys;
+	ll_node_t** nodes = index->nodes;
+	unsigned int i, capacity = index->capacity;
 
-	return g;
+	edge_index_alloc(index, capacity * 2);
+	for (i = 0; i != capacity; ++i)
+		if (nodes[i])
+			edge_index_insert(index, keys[i], nodes[i]);
+
+	free(keys);
+	free(nodes);
 }
 
-void
-lg_add_edge(list_graph_t* graph, int src, int dest)
+static void
+edge_index_insert(lg_edge_index_t* index, unsigned long long key, ll_node_t* node)
 {
-	if (
-		!graph || !graph->neighbors
-		|| !is_node_in_graph(src, graph->nodes)
-		|| !is_node_in_graph(dest, graph->nodes)
-	)
-		return;
+	unsigned int i;
+
+	/* keep the load factor at most 1/2 */
+	if (2 * (index->size + 1) > index->capacity)
+		edge_index_grow(index);
 
-	ll_add_nth_node(graph->neighbors[src], graph->neighbors[src]->size, &dest);
+	for (i = edge_slot(index, key); index->nodes[i]; i = (i + 1) & (index->capacity - 1))
+		;
+
+	index->keys[i] = key;
+	index->nodes[i] = node;
+	++index->size;
 }
 
-static ll_node_t *find_node(linked_list_t *ll, int node, unsigned int *pos)
+/* Slot holding key (and node, unless node is NULL), or capacity if missing. */
+static unsigned int
+edge_index_find(lg_edge_index_t* index, unsigned long long key, ll_node_t* node)
 {
-	ll_node_t *crt = ll->head;
 	unsigned int i;
 
-	for (i = 0; i != ll->size; ++i) {
-		if (node == *(int *)crt->data) {
-			*pos = i;
-			return crt;
+	for (i = edge_slot(index, key); index->nodes[i]; i = (i + 1) & (index->capacity - 1))
+		if (index->keys[i] == key && (!node || index->nodes[i] == node))
+			return i;
+
+	return index->capacity;
+}
+
+/* Backward-shift deletion, so no tombstones are ever left behind. */
+static void
+edge_index_erase(lg_edge_index_t* index, unsigned int i)
+{
+	unsigned int mask = index->capacity - 1, j = i, home;
+
+	for (;;) {
+		index->nodes[i] = NULL;
+
+		for (;;) {
+			j = (j + 1) & mask;
+			if (!index->nodes[j]) {
+				--index->size;
+				return;
+			}
+
+			home = edge_slot(index, index->keys[j]);
+			/* entry j may move into the hole only if i is on its probe path */
+			if (i <= j ? (home <= i || home > j) : (home <= i && home > j))
+				break;
 		}
 
-		crt = crt->next;
+		index->keys[i] = index->keys[j];
+		index->nodes[i] = index->nodes[j];
+		i = j;
 	}
+}
 
-	return NULL;
+/*
+ * Lock-free union-find: parents only ever point to smaller ids and are changed
+ * with CAS, so uf_find and uf_union may run on several threads at once.
+ */
+static int
+uf_find(int* parent, int x)
+{
+	int p, gp;
+
+	for (;;) {
+		p = __atomic_load_n(&parent[x], __ATOMIC_RELAXED);
+		if (p == x)
+			return x;
+
+		gp = __atomic_load_n(&parent[p], __ATOMIC_RELAXED);
+		if (gp != p) /* path halving */
+			__atomic_compare_exchange_n(&parent[x], &p, gp, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED);
+		x = gp;
+	}
 }
 
-int
-lg_has_edge(list_graph_t* graph, int src, int dest)
+static void
+uf_union(int* parent, int a, int b)
 {
-	unsigned int pos;
+	int tmp;
+
+	for (;;) {
+		a = uf_find(parent, a);
+		b = uf_find(parent, b);
+		if (a == b)
+			return;
+
+		if (a < b) {
+			tmp = a;
+			a = b;
+			b = tmp;
+		}
+
+		/* a is the larger root; it may have been linked meanwhile */
+		if (__atomic_compare_exchange_n(&parent[a], &a, b, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return;
+	}
+}
+
+/* Turns roots into labels 0, 1, ... in the order of their smallest node. */
+static int
+uf_label(int* parent, int nodes, int* component)
+{
+	int i, count = 0;
+
+	for (i = 0; i != nodes; ++i) {
+		if (parent[i] == i)
+			component[i] = count++;
+		else
+			component[i] = component[uf_find(parent, i)];
+	}
+
+	return count;
+}
+
+list_graph_t*
+lg_create(int nodes)
+{
+	int i;
+
+	list_graph_t *g = malloc(sizeof(*g));
+	DIE(!g, "malloc graph failed");
+
+	g->neighbors = malloc(nodes * sizeof(*g->neighbors));
+	DIE(!g->neighbors, "malloc neighbours failed");
+
+	for (i = 0; i != nodes; ++i)
+		g->neighbors[i] = ll_create(sizeof(int));
+
+	g->nodes = nodes;
+	g->weighted = 0;
+	g->arena = NULL;
+	g->index = NULL;
+	g->components = NULL;
+
+	return g;
+}
+
+/*
+ * Same as lg_create, but every edge also carries an int weight (see
+ * lg_add_weighted_edge). Edges added through lg_add_edge weigh 1.
+ */
+list_graph_t*
+lg_create_weighted(int nodes)
+{
+	int i;
+
+	list_graph_t *g = malloc(sizeof(*g));
+	DIE(!g, "malloc graph failed");
+
+	g->neighbors = malloc(nodes * sizeof(*g->neighbors));
+	DIE(!g->neighbors, "malloc neighbours failed");
+
+	for (i = 0; i != nodes; ++i)
+		g->neighbors[i] = ll_create(sizeof(lg_wedge_t));
+
+	g->nodes = nodes;
+	g->weighted = 1;
+	g->arena = NULL;
+	g->index = NULL;
+	g->components = NULL;
+
+	return g;
+}
+
+/*
+ * Same as lg_create, but all adjacency nodes come from one slab arena owned by
+ * the graph, with the neighbour id stored inline.
+ */
+list_graph_t*
+lg_create_slab(int nodes)
+{
+	int i;
+
+	list_graph_t *g = malloc(sizeof(*g));
+	DIE(!g, "malloc graph failed");
+
+	g->neighbors = malloc(nodes * sizeof(*g->neighbors));
+	DIE(!g->neighbors, "malloc neighbours failed");
+
+	g->arena = ll_arena_create(sizeof(int), nodes > 64 ? nodes : 64);
+
+	for (i = 0; i != nodes; ++i)
+		g->neighbors[i] = ll_create_in(sizeof(int), g->arena);
+
+	g->nodes = nodes;
+	g->weighted = 0;
+	g->index = NULL;
+	g->components = NULL;
+
+	return g;
+}
+
+/*
+ * In an unweighted graph the weight is ignored, so this is plain lg_add_edge.
+ */
+void
+lg_add_weighted_edge(list_graph_t* graph, int src, int dest, int weight)
+{
+	/* the lists only copy data_size bytes, i.e. just dest when unweighted */
+	lg_wedge_t edge = { dest, weight };
+
+	if (
+		!graph || !graph->neighbors
+		|| !is_node_in_graph(src, graph->nodes)
+		|| !is_node_in_graph(dest, graph->nodes)
+	)
+		return;
+
+	if (graph->components && !graph->components->dirty)
+		uf_union(graph->components->parent, src, dest);
+
+	if (graph->index) {
+		/* the index makes order irrelevant, so skip the walk to the tail */
+		ll_add_nth_node(graph->neighbors[src], 0, &edge);
+		edge_index_insert(graph->index, edge_key(src, dest),
+			graph->neighbors[src]->head);
+		return;
+	}
+
+	ll_add_nth_node(graph->neighbors[src], graph->neighbors[src]->size, &edge);
+}
+
+void
+lg_add_edge(list_graph_t* graph, int src, int dest)
+{
+	lg_add_weighted_edge(graph, src, dest, 1);
+}
+
+/*
+ * Indexes every edge currently in the graph by (src, dest). From then on
+ * lg_add_edge, lg_add_edges and lg_remove_edge keep the index up to date, and
+ * lg_has_edge / lg_remove_edge run in expected O(1). While the index is on,
+ * lg_add_edge inserts at the front of the list and lg_remove_edge may reorder
+ * it, so neighbour order is no longer insertion order.
+ */
+void
+lg_build_edge_index(list_graph_t* graph)
+{
+	unsigned int edges = 0, capacity = LG_INDEX_MIN_CAPACITY;
+	ll_node_t* crt;
+	int i;
+
+	if (!graph || !graph->neighbors || graph->index)
+		return;
+
+	for (i = 0; i != graph->nodes; ++i)
+		edges += graph->neighbors[i]->size;
+	while (capacity < 2 * edges)
+		capacity *= 2;
+
+	graph->index = malloc(sizeof(*graph->index));
+	DIE(!graph->index, "malloc edge index failed");
+	edge_index_alloc(graph->index, capacity);
+
+	for (i = 0; i != graph->nodes; ++i)
+		for (crt = graph->neighbors[i]->head; crt; crt = crt->next)
+			edge_index_insert(graph->index,
+				edge_key(i, *(int*)crt->data), crt);
+}
+
+void
+lg_free_edge_index(list_graph_t* graph)
+{
+	if (!graph || !graph->index)
+		return;
+
+	free(graph->index->keys);
+	free(graph->index->nodes);
+	free(graph->index);
+	graph->index = NULL;
+}
+
+/*
+ * Adds count edges given as (src, dest) pairs: edges[2 * i] -> edges[2 * i + 1].
+ * Each list is walked at most once to find its tail, after which appends are
+ * O(1), so the whole batch costs O(nodes + count + existing edges).
+ * weights[i] is the weight of edge i; with weights == NULL every edge weighs 1.
+ */
+void
+lg_add_weighted_edges(list_graph_t* graph, const int* edges, const int* weights,
+	unsigned int count)
+{
+	ll_node_t** tails;
+	ll_node_t* node;
+	linked_list_t* list;
+	lg_wedge_t edge;
+	unsigned int i;
+	int src, dest;
+
+	if (!graph || !graph->neighbors || !edges)
+		return;
+
+	tails = calloc(graph->nodes ? graph->nodes : 1, sizeof(*tails));
+	DIE(!tails, "calloc tails failed");
+
+	for (i = 0; i != count; ++i) {
+		src = edges[2 * i];
+		dest = edges[2 * i + 1];
+
+		if (
+			!is_node_in_graph(src, graph->nodes)
+			|| !is_node_in_graph(dest, graph->nodes)
+		)
+			continue;
+
+		list = graph->neighbors[src];
+		if (!tails[src] && list->size)
+			tails[src] = get_nth_node(list, list->size - 1);
+
+		edge.dest = dest;
+		edge.weight = weights ? weights[i] : 1;
+		node = create_node(list, &edge);
+		if (tails[src])
+			tails[src]->next = node;
+		else
+			list->head = node;
+		tails[src] = node;
+		++list->size;
+
+		if (graph->index)
+			edge_index_insert(graph->index, edge_key(src, dest), node);
+		if (graph->components && !graph->components->dirty)
+			uf_union(graph->components->parent, src, dest);
+	}
+
+	free(tails);
+}
+
+void
+lg_add_edges(list_graph_t* graph, const int* edges, unsigned int count)
+{
+	lg_add_weighted_edges(graph, edges, NULL, count);
+}
+
+static ll_node_t *find_node(linked_list_t *ll, int node, unsigned int *pos)
+{
+	ll_node_t *crt = ll->head;
+	unsigned int i;
+
+	for (i = 0; i != ll->size; ++i) {
+		if (node == *(int *)crt->data) {
+			*pos = i;
+			return crt;
+		}
+
+		crt = crt->next;
+	}
+
+	return NULL;
+}
+
+int
+lg_has_edge(list_graph_t* graph, int src, int dest)
+{
+	unsigned int pos;
 
 	if (
 		!graph || !graph->neighbors
@@ -424,371 +1590,4002 @@ lg_has_edge(list_graph_t* graph, int src, int dest)
 	)
 		return 0;
 
+	if (graph->index)
+		return edge_index_find(graph->index, edge_key(src, dest), NULL)
+			!= graph->index->capacity;
+
 	return find_node(graph->neighbors[src], dest, &pos) != NULL;
 }
 
-linked_list_t*
-lg_get_neighbours(list_graph_t* graph, int node)
-{
-	if (
-		!graph || !graph->neighbors
-		|| !is_node_in_graph(node, graph->nodes)
-	)
-		return NULL;
-
-	return graph->neighbors[node];
+linked_list_t*
+lg_get_neighbours(list_graph_t* graph, int node)
+{
+	if (
+		!graph || !graph->neighbors
+		|| !is_node_in_graph(node, graph->nodes)
+	)
+		return NULL;
+
+	return graph->neighbors[node];
+}
+
+static void
+lg_rebuild_components(list_graph_t* graph)
+{
+	int* parent = graph->components->parent;
+	ll_node_t* crt;
+	int i;
+
+	for (i = 0; i != graph->nodes; ++i)
+		parent[i] = i;
+
+	for (i = 0; i != graph->nodes; ++i)
+		for (crt = graph->neighbors[i]->head; crt; crt = crt->next)
+			uf_union(parent, i, *(int*)crt->data);
+
+	graph->components->dirty = 0;
+}
+
+/*
+ * Starts tracking the (undirected) connected components of the graph. Edges
+ * added afterwards with lg_add_edge / lg_add_edges are merged in as they come,
+ * without relabelling anything.
+ */
+void
+lg_track_components(list_graph_t* graph)
+{
+	if (!graph || !graph->neighbors || graph->components)
+		return;
+
+	graph->components = malloc(sizeof(*graph->components));
+	DIE(!graph->components, "malloc components failed");
+
+	graph->components->parent = malloc(
+		(graph->nodes ? graph->nodes : 1) * sizeof(int));
+	DIE(!graph->components->parent, "malloc parent failed");
+
+	lg_rebuild_components(graph);
+}
+
+void
+lg_free_components(list_graph_t* graph)
+{
+	if (!graph || !graph->components)
+		return;
+
+	free(graph->components->parent);
+	free(graph->components);
+	graph->components = NULL;
+}
+
+/* Smallest node in the component of node, or -1. Needs lg_track_components. */
+int
+lg_get_component(list_graph_t* graph, int node)
+{
+	if (
+		!graph || !graph->components
+		|| !is_node_in_graph(node, graph->nodes)
+	)
+		return -1;
+
+	if (graph->components->dirty)
+		lg_rebuild_components(graph);
+
+	return uf_find(graph->components->parent, node);
+}
+
+/*
+ * Labels every node with its component in one call, edges taken as
+ * undirected. Labels go 0, 1, ... in the order of each component's smallest
+ * node, which is what calling component_arrays for i = 0, 1, ... gives on a
+ * graph that stores both directions. Returns the number of components.
+ */
+int
+lg_connected_components(list_graph_t* graph, int* component)
+{
+	lg_components_t* tracked;
+	int count;
+
+	if (!graph || !graph->neighbors || !component)
+		return 0;
+
+	tracked = graph->components;
+	if (!tracked)
+		lg_track_components(graph);
+	else if (tracked->dirty)
+		lg_rebuild_components(graph);
+
+	count = uf_label(graph->components->parent, graph->nodes, component);
+
+	if (!tracked)
+		lg_free_components(graph);
+
+	return count;
+}
+
+/*
+ * O(1) removal through the index: the payload of the list head is moved into
+ * the node being removed, then the head is unlinked instead. Returns 0 if there
+ * is no such edge.
+ */
+static int
+lg_remove_indexed_edge(list_graph_t* graph, int src, int dest)
+{
+	lg_edge_index_t* index = graph->index;
+	linked_list_t* list = graph->neighbors[src];
+	ll_node_t *node, *head = list->head;
+	unsigned int i;
+
+	i = edge_index_find(index, edge_key(src, dest), NULL);
+	if (i == index->capacity)
+		return 0;
+
+	node = index->nodes[i];
+	edge_index_erase(index, i);
+
+	if (node != head) {
+		i = edge_index_find(index, edge_key(src, *(int*)head->data), head);
+		index->nodes[i] = node;
+		memcpy(node->data, head->data, list->data_size);
+	}
+
+	ll_free_node(list, ll_remove_nth_node(list, 0));
+
+	return 1;
+}
+
+/* returns 1 if an edge src -> dest was removed, 0 if there was none */
+int
+lg_remove_edge(list_graph_t* graph, int src, int dest)
+{
+	unsigned int pos;
+
+	if (
+		!graph || !graph->neighbors
+		|| !is_node_in_graph(src, graph->nodes)
+		|| !is_node_in_graph(dest, graph->nodes)
+	)
+		return 0;
+
+	if (graph->index) {
+		if (!lg_remove_indexed_edge(graph, src, dest))
+			return 0;
+	} else {
+		if (!find_node(graph->neighbors[src], dest, &pos))
+			return 0;
+
+		ll_free_node(graph->neighbors[src],
+			ll_remove_nth_node(graph->neighbors[src], pos));
+	}
+
+	/* only an edge that was really removed can split a component */
+	if (graph->components)
+		graph->components->dirty = 1;
+
+	return 1;
+}
+
+void
+lg_free(list_graph_t* graph)
+{
+	int i;
+
+	if (graph->arena) {
+		/* the nodes live in the slabs, no need to walk the lists */
+		for (i = 0; i != graph->nodes; ++i)
+			free(graph->neighbors[i]);
+		ll_arena_free(graph->arena);
+	} else {
+		for (i = 0; i != graph->nodes; ++i)
+			ll_free(graph->neighbors + i);
+	}
+
+	lg_free_edge_index(graph);
+	lg_free_components(graph);
+	free(graph->neighbors);
+	free(graph);
+}
+
+csr_graph_t*
+csr_create(int nodes, unsigned int edges)
+{
+	csr_graph_t* csr = malloc(sizeof(*csr));
+	DIE(!csr, "malloc csr failed");
+
+	csr->offsets = calloc(nodes + 1, sizeof(*csr->offsets));
+	DIE(!csr->offsets, "calloc offsets failed");
+
+	csr->adj = malloc((edges ? edges : 1) * sizeof(*csr->adj));
+	DIE(!csr->adj, "malloc adj failed");
+
+	csr->weights = NULL;
+	csr->nodes = nodes;
+	csr->edges = edges;
+	csr->map = NULL;
+	csr->map_size = 0;
+
+	return csr;
+}
+
+csr_graph_t*
+lg_freeze(list_graph_t* graph)
+{
+	csr_graph_t* csr;
+	ll_node_t* crt;
+	unsigned int edges = 0, pos;
+	int i;
+
+	if (!graph || !graph->neighbors)
+		return NULL;
+
+	for (i = 0; i != graph->nodes; ++i)
+		edges += ll_get_size(graph->neighbors[i]);
+
+	csr = csr_create(graph->nodes, edges);
+	if (graph->weighted) {
+		csr->weights = malloc((edges ? edges : 1) * sizeof(*csr->weights));
+		DIE(!csr->weights, "malloc weights failed");
+	}
+
+	for (i = 0, pos = 0; i != graph->nodes; ++i) {
+		csr->offsets[i] = pos;
+		for (crt = graph->neighbors[i]->head; crt; crt = crt->next) {
+			if (csr->weights)
+				csr->weights[pos] = ((lg_wedge_t*)crt->data)->weight;
+			csr->adj[pos++] = *(int*)crt->data;
+		}
+	}
+	csr->offsets[graph->nodes] = pos;
+
+	return csr;
+}
+
+csr_graph_t*
+csr_transpose(csr_graph_t* csr)
+{
+	csr_graph_t* t_csr;
+	unsigned int* pos;
+	unsigned int e;
+	int u;
+
+	if (!csr)
+		return NULL;
+
+	t_csr = csr_create(csr->nodes, csr->edges);
+	if (csr->weights) {
+		t_csr->weights = malloc((csr->edges ? csr->edges : 1)
+			* sizeof(*t_csr->weights));
+		DIE(!t_csr->weights, "malloc weights failed");
+	}
+
+	for (e = 0; e != csr->edges; ++e)
+		++t_csr->offsets[csr->adj[e] + 1];
+	for (u = 0; u != csr->nodes; ++u)
+		t_csr->offsets[u + 1] += t_csr->offsets[u];
+
+	pos = malloc((csr->nodes ? csr->nodes : 1) * sizeof(*pos));
+	DIE(!pos, "malloc pos failed");
+	memcpy(pos, t_csr->offsets, csr->nodes * sizeof(*pos));
+
+	for (u = 0; u != csr->nodes; ++u)
+		for (e = csr->offsets[u]; e != csr->offsets[u + 1]; ++e) {
+			if (csr->weights)
+				t_csr->weights[pos[csr->adj[e]]] = csr->weights[e];
+			t_csr->adj[pos[csr->adj[e]]++] = u;
+		}
+
+	free(pos);
+	return t_csr;
+}
+
+typedef struct
+{
+	const int* edges;
+	unsigned int begin;
+	unsigned int end;
+	int nodes;
+	unsigned int* cursor;
+	csr_graph_t* csr;
+} csr_load_arg_t;
+
+static void*
+csr_count_degrees(void* arg)
+{
+	csr_load_arg_t* a = arg;
+	unsigned int i;
+	int src, dest;
+
+	for (i = a->begin; i != a->end; ++i) {
+		src = a->edges[2 * i];
+		dest = a->edges[2 * i + 1];
+		if (is_node_in_graph(src, a->nodes) && is_node_in_graph(dest, a->nodes))
+			++a->cursor[src];
+	}
+
+	return NULL;
+}
+
+static void*
+csr_scatter_edges(void* arg)
+{
+	csr_load_arg_t* a = arg;
+	unsigned int i;
+	int src, dest;
+
+	for (i = a->begin; i != a->end; ++i) {
+		src = a->edges[2 * i];
+		dest = a->edges[2 * i + 1];
+		if (is_node_in_graph(src, a->nodes) && is_node_in_graph(dest, a->nodes))
+			a->csr->adj[a->cursor[src]++] = dest;
+	}
+
+	return NULL;
+}
+
+static void
+csr_run_load(void* (*fn)(void*), csr_load_arg_t* args, pthread_t* tids,
+	int threads)
+{
+	int t;
+
+	if (threads == 1) {
+		fn(args);
+		return;
+	}
+
+	for (t = 0; t != threads; ++t)
+		DIE(pthread_create(tids + t, NULL, fn, args + t), "pthread_create");
+	for (t = 0; t != threads; ++t)
+		pthread_join(tids[t], NULL);
+}
+
+/*
+ * Builds a CSR graph straight from count (src, dest) pairs laid out like in
+ * lg_add_edges, without going through linked lists: one pass counts the
+ * degrees, a second one scatters the destinations. With threads > 1 every
+ * thread owns a contiguous slice of the input and its own degree counters, so
+ * the neighbour order is the input order no matter how many threads are used.
+ * Those counters cost threads * nodes, so threads is lowered until they take
+ * at most two per edge; a graph with far more nodes than edges per thread is
+ * loaded by one thread. Pairs with a node outside [0, nodes) are skipped.
+ */
+csr_graph_t*
+csr_from_edges(int nodes, const int* edges, unsigned int count, int threads)
+{
+	csr_load_arg_t* args;
+	pthread_t* tids;
+	csr_graph_t* csr;
+	unsigned int* cursors;
+	unsigned int chunk, pos = 0;
+	int t, u;
+
+	if (nodes < 0 || (count && !edges))
+		return NULL;
+
+	if (threads < 1)
+		threads = 1;
+	if ((unsigned int)threads > count)
+		threads = count ? count : 1;
+	if ((size_t)threads * (nodes + 1) > 2 * (size_t)count)
+		threads = MIN((size_t)threads, 2 * (size_t)count / (nodes + 1));
+	if (threads < 1)
+		threads = 1;
+
+	args = calloc(threads, sizeof(*args));
+	tids = malloc(threads * sizeof(*tids));
+	cursors = calloc((size_t)threads * (nodes + 1), sizeof(*cursors));
+	DIE(!args || !tids || !cursors, "calloc load buffers failed");
+
+	csr = csr_create(nodes, 0);
+
+	chunk = count / threads;
+	for (t = 0; t != threads; ++t) {
+		args[t].edges = edges;
+		args[t].begin = t * chunk;
+		args[t].end = t == threads - 1 ? count : (t + 1) * chunk;
+		args[t].nodes = nodes;
+		args[t].cursor = cursors + (size_t)t * (nodes + 1);
+		args[t].csr = csr;
+	}
+
+	csr_run_load(csr_count_degrees, args, tids, threads);
+
+	/* per-thread counters become per-thread write cursors */
+	for (u = 0; u != nodes; ++u) {
+		csr->offsets[u] = pos;
+		for (t = 0; t != threads; ++t) {
+			unsigned int deg = args[t].cursor[u];
+
+			args[t].cursor[u] = pos;
+			pos += deg;
+		}
+	}
+	csr->offsets[nodes] = pos;
+
+	csr->edges = pos;
+	free(csr->adj);
+	csr->adj = malloc((pos ? pos : 1) * sizeof(*csr->adj));
+	DIE(!csr->adj, "malloc adj failed");
+
+	csr_run_load(csr_scatter_edges, args, tids, threads);
+
+	free(cursors);
+	free(tids);
+	free(args);
+
+	return csr;
+}
+
+/* Bitmaps with one bit per node, used as visited / frontier sets. */
+#define BITMAP_WORD_BITS (8 * sizeof(unsigned long))
+#define BITMAP_WORDS(n) (((n) + BITMAP_WORD_BITS - 1) / BITMAP_WORD_BITS)
+
+static inline int
+bitmap_test(const unsigned long* bm, int i)
+{
+	return (bm[i / BITMAP_WORD_BITS] >> (i % BITMAP_WORD_BITS)) & 1;
+}
+
+static inline void
+bitmap_set(unsigned long* bm, int i)
+{
+	bm[i / BITMAP_WORD_BITS] |= 1ul << (i % BITMAP_WORD_BITS);
+}
+
+unsigned int
+csr_get_degree(csr_graph_t* csr, int node)
+{
+	if (!csr || !is_node_in_graph(node, csr->nodes))
+		return 0;
+
+	return csr->offsets[node + 1] - csr->offsets[node];
+}
+
+void
+csr_free(csr_graph_t* csr)
+{
+	if (!csr)
+		return;
+
+	if (csr->map) {
+		munmap(csr->map, csr->map_size);
+		free(csr);
+		return;
+	}
+
+	free(csr->offsets);
+	free(csr->adj);
+	free(csr->weights);
+	free(csr);
+}
+
+/*
+ * On-disk CSR snapshot: a 64-byte header followed by the offsets and the
+ * neighbour array exactly as they sit in memory (native byte order, checked
+ * through byte_order), so csr_map() only has to mmap the file. With
+ * CSR_FILE_WEIGHTS set, the weights follow right after the neighbour array.
+ * Weights came with version 2; version 1 files are still read, and they never
+ * have that flag.
+ */
+#define CSR_FILE_MAGIC "LGCSR\0\0\0"
+#define CSR_FILE_VERSION 2
+#define CSR_FILE_BYTE_ORDER 0x01020304u
+#define CSR_FILE_CHECKSUM 1u
+#define CSR_FILE_WEIGHTS 2u
+#define CSR_FILE_FLAGS (CSR_FILE_CHECKSUM | CSR_FILE_WEIGHTS)
+
+typedef struct
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int byte_order;
+	unsigned int flags;
+	unsigned int nodes;
+	unsigned int edges;
+	unsigned int reserved;
+	unsigned long long offsets_pos;
+	unsigned long long adj_pos;
+	unsigned long long checksum;
+	unsigned long long file_size;
+} csr_file_header_t;
+
+/* FNV-1a over the offsets, neighbour and weight arrays */
+static unsigned long long
+csr_checksum(const csr_graph_t* csr)
+{
+	const unsigned char* p;
+	unsigned long long h = 0xcbf29ce484222325ull;
+	size_t i, len;
+
+	p = (const unsigned char*)csr->offsets;
+	len = (csr->nodes + 1) * sizeof(*csr->offsets);
+	for (i = 0; i != len; ++i)
+		h = (h ^ p[i]) * 0x100000001b3ull;
+
+	p = (const unsigned char*)csr->adj;
+	len = csr->edges * sizeof(*csr->adj);
+	for (i = 0; i != len; ++i)
+		h = (h ^ p[i]) * 0x100000001b3ull;
+
+	if (!csr->weights)
+		return h;
+
+	p = (const unsigned char*)csr->weights;
+	len = csr->edges * sizeof(*csr->weights);
+	for (i = 0; i != len; ++i)
+		h = (h ^ p[i]) * 0x100000001b3ull;
+
+	return h;
+}
+
+static int
+write_all(int fd, const void* buf, size_t len)
+{
+	const char* p = buf;
+	ssize_t ret;
+
+	while (len) {
+		ret = write(fd, p, len);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		p += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+/*
+ * Writes csr to path (with a checksum if checksum != 0). Returns 0, or -1 with
+ * errno set.
+ */
+int
+csr_save(csr_graph_t* csr, const char* path, int checksum)
+{
+	csr_file_header_t hdr;
+	static const char zeros[8];
+	size_t offsets_len, adj_len;
+	int fd, ret;
+
+	if (!csr || !path) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	offsets_len = (csr->nodes + 1) * sizeof(*csr->offsets);
+	adj_len = csr->edges * sizeof(*csr->adj);
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, CSR_FILE_MAGIC, sizeof(hdr.magic));
+	hdr.version = CSR_FILE_VERSION;
+	hdr.byte_order = CSR_FILE_BYTE_ORDER;
+	hdr.flags = checksum ? CSR_FILE_CHECKSUM : 0;
+	if (csr->weights)
+		hdr.flags |= CSR_FILE_WEIGHTS;
+	hdr.nodes = csr->nodes;
+	hdr.edges = csr->edges;
+	hdr.offsets_pos = sizeof(hdr);
+	/* keep the neighbour array 8-byte aligned */
+	hdr.adj_pos = (hdr.offsets_pos + offsets_len + 7) & ~7ull;
+	hdr.file_size = hdr.adj_pos + (csr->weights ? 2 : 1) * adj_len;
+	hdr.checksum = checksum ? csr_checksum(csr) : 0;
+
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return -1;
+
+	ret = write_all(fd, &hdr, sizeof(hdr));
+	if (!ret)
+		ret = write_all(fd, csr->offsets, offsets_len);
+	if (!ret)
+		ret = write_all(fd, zeros, hdr.adj_pos - hdr.offsets_pos - offsets_len);
+	if (!ret)
+		ret = write_all(fd, csr->adj, adj_len);
+	if (!ret && csr->weights)
+		ret = write_all(fd, csr->weights, adj_len);
+
+	if (close(fd) && !ret)
+		ret = -1;
+
+	return ret;
+}
+
+int
+lg_save(list_graph_t* graph, const char* path, int checksum)
+{
+	csr_graph_t* csr = lg_freeze(graph);
+	int ret;
+
+	if (!csr) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	ret = csr_save(csr, path, checksum);
+	csr_free(csr);
+
+	return ret;
+}
+
+/*
+ * Header checks done on every map, so that even without verify nothing reads
+ * outside the file: both arrays 4-byte aligned and in bounds (written so that
+ * no sum can wrap), no unknown flags, and offsets[0] == 0, offsets[nodes] ==
+ * edges. Returns 0 if the header is usable.
+ */
+static int
+csr_file_check(const csr_file_header_t* hdr, unsigned long long size)
+{
+	unsigned long long offsets_len, adj_len;
+	const unsigned int* offsets;
+
+	if (memcmp(hdr->magic, CSR_FILE_MAGIC, sizeof(hdr->magic))
+		|| hdr->version < 1 || hdr->version > CSR_FILE_VERSION
+		|| hdr->byte_order != CSR_FILE_BYTE_ORDER
+		|| hdr->flags & ~CSR_FILE_FLAGS
+		|| (hdr->version == 1 && hdr->flags & CSR_FILE_WEIGHTS)
+		|| hdr->file_size != size
+		|| hdr->nodes > INT_MAX)
+		return -1;
+
+	/* at most 2^33 and 2^35 bytes, so these products cannot wrap */
+	offsets_len = (hdr->nodes + 1ull) * sizeof(unsigned int);
+	adj_len = (hdr->flags & CSR_FILE_WEIGHTS ? 2 : 1)
+		* (unsigned long long)hdr->edges * sizeof(int);
+
+	if (hdr->offsets_pos < sizeof(*hdr)
+		|| hdr->offsets_pos % sizeof(unsigned int)
+		|| hdr->adj_pos % sizeof(int)
+		|| hdr->offsets_pos > size
+		|| offsets_len > size - hdr->offsets_pos
+		|| hdr->adj_pos < hdr->offsets_pos + offsets_len
+		|| hdr->adj_pos > size
+		|| adj_len > size - hdr->adj_pos)
+		return -1;
+
+	offsets = (const unsigned int*)((const char*)hdr + hdr->offsets_pos);
+	if (offsets[0] || offsets[hdr->nodes] != hdr->edges)
+		return -1;
+
+	return 0;
+}
+
+/* full pass for verify: monotonic offsets and neighbours inside the graph */
+static int
+csr_file_verify(const csr_graph_t* csr)
+{
+	unsigned int e;
+	int u;
+
+	for (u = 0; u != csr->nodes; ++u)
+		if (csr->offsets[u] > csr->offsets[u + 1])
+			return -1;
+
+	for (e = 0; e != csr->edges; ++e)
+		if (csr->adj[e] < 0 || csr->adj[e] >= csr->nodes)
+			return -1;
+
+	return 0;
+}
+
+/*
+ * Maps a file written by csr_save read-only; nothing is parsed or copied and
+ * the pages are shared with every other process mapping the same file. With
+ * verify != 0 the checksum (if present) and every offset and neighbour are
+ * checked, which touches every page.
+ * Returns NULL with errno set if the file is missing, malformed or corrupt.
+ * csr_free() unmaps it.
+ */
+csr_graph_t*
+csr_map(const char* path, int verify)
+{
+	csr_file_header_t* hdr;
+	csr_graph_t* csr;
+	struct stat st;
+	void* map;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	if (fstat(fd, &st)) {
+		close(fd);
+		return NULL;
+	}
+
+	if ((size_t)st.st_size < sizeof(*hdr)) {
+		close(fd);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return NULL;
+
+	hdr = map;
+	if (csr_file_check(hdr, st.st_size)) {
+		munmap(map, st.st_size);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	csr = malloc(sizeof(*csr));
+	DIE(!csr, "malloc csr failed");
+
+	csr->offsets = (unsigned int*)((char*)map + hdr->offsets_pos);
+	csr->adj = (int*)((char*)map + hdr->adj_pos);
+	csr->weights = hdr->flags & CSR_FILE_WEIGHTS ? csr->adj + hdr->edges : NULL;
+	csr->nodes = hdr->nodes;
+	csr->edges = hdr->edges;
+	csr->map = map;
+	csr->map_size = st.st_size;
+
+	if (verify && (((hdr->flags & CSR_FILE_CHECKSUM)
+		&& csr_checksum(csr) != hdr->checksum) || csr_file_verify(csr))) {
+		csr_free(csr);
+		errno = EINVAL;
+		return NULL;
+	}
+
+	return csr;
+}
+
+#define VCSR_PADDING 8
+#define VCSR_HIGH_BITS 0x8080808080808080ull
+
+static unsigned char*
+varint_put(unsigned char* p, unsigned int x)
+{
+	while (x >= 0x80) {
+		*p++ = (unsigned char)(x | 0x80);
+		x >>= 7;
+	}
+	*p++ = (unsigned char)x;
+
+	return p;
+}
+
+static int
+cmp_int(const void* a, const void* b)
+{
+	int x = *(const int*)a, y = *(const int*)b;
+
+	return x < y ? -1 : x > y;
+}
+
+vcsr_graph_t*
+csr_compress(csr_graph_t* csr)
+{
+	vcsr_graph_t* vcsr;
+	unsigned char *buf, *p;
+	unsigned int e, begin, end, deg;
+	int *sorted, u, prev;
+	long first;
+
+	if (!csr)
+		return NULL;
+
+	vcsr = malloc(sizeof(*vcsr));
+	DIE(!vcsr, "malloc vcsr failed");
+
+	vcsr->nodes = csr->nodes;
+	vcsr->edges = csr->edges;
+	vcsr->max_degree = 0;
+	vcsr->offsets = malloc((csr->nodes + 1) * sizeof(*vcsr->offsets));
+	DIE(!vcsr->offsets, "malloc offsets failed");
+
+	/* worst case is 5 bytes per edge, shrunk to size at the end */
+	buf = malloc((size_t)csr->edges * 5 + VCSR_PADDING);
+	sorted = malloc((csr->edges ? csr->edges : 1) * sizeof(*sorted));
+	DIE(!buf || !sorted, "malloc vcsr buffers failed");
+	memcpy(sorted, csr->adj, csr->edges * sizeof(*sorted));
+
+	p = buf;
+	for (u = 0; u != csr->nodes; ++u) {
+		begin = csr->offsets[u];
+		end = csr->offsets[u + 1];
+		deg = end - begin;
+		if (deg > vcsr->max_degree)
+			vcsr->max_degree = deg;
+
+		vcsr->offsets[u] = p - buf;
+		if (!deg)
+			continue;
+
+		qsort(sorted + begin, deg, sizeof(*sorted), cmp_int);
+
+		first = (long)sorted[begin] - u;
+		p = varint_put(p, (unsigned int)(first < 0 ? -2 * first - 1 : 2 * first));
+		for (prev = sorted[begin], e = begin + 1; e != end; prev = sorted[e++])
+			p = varint_put(p, (unsigned int)(sorted[e] - prev));
+	}
+	vcsr->offsets[csr->nodes] = p - buf;
+
+	memset(p, 0, VCSR_PADDING);
+	vcsr->data = realloc(buf, (p - buf) + VCSR_PADDING);
+	DIE(!vcsr->data, "realloc vcsr data failed");
+
+	free(sorted);
+	return vcsr;
+}
+
+static inline unsigned int
+varint_get(const unsigned char** pp)
+{
+	const unsigned char* p = *pp;
+	unsigned int x = 0, shift = 0;
+
+	do {
+		x |= (unsigned int)(*p & 0x7f) << shift;
+		shift += 7;
+	} while (*p++ & 0x80);
+
+	*pp = p;
+	return x;
+}
+
+/*
+ * Decodes the neighbours of node into out (max_degree entries) and returns
+ * how many there are. Gaps below 128 are one byte each, so whole 8-byte words
+ * without any continuation bit are decoded at once (SWAR) before falling back
+ * to the byte-by-byte loop.
+ */
+unsigned int
+vcsr_get_neighbours(vcsr_graph_t* vcsr, int node, int* out)
+{
+	const unsigned char *p, *end;
+	unsigned long long word;
+	unsigned int count = 0, zz;
+	int prev, i;
+
+	if (!vcsr || !is_node_in_graph(node, vcsr->nodes))
+		return 0;
+
+	p = vcsr->data + vcsr->offsets[node];
+	end = vcsr->data + vcsr->offsets[node + 1];
+	if (p == end)
+		return 0;
+
+	zz = varint_get(&p);
+	prev = node + (zz & 1 ? -(int)(zz >> 1) - 1 : (int)(zz >> 1));
+	out[count++] = prev;
+
+	while (p < end) {
+		if (end - p >= 8) {
+			memcpy(&word, p, sizeof(word));
+			if (!(word & VCSR_HIGH_BITS)) {
+				for (i = 0; i != 8; ++i) {
+					prev += p[i];
+					out[count++] = prev;
+				}
+				p += 8;
+				continue;
+			}
+		}
+
+		prev += varint_get(&p);
+		out[count++] = prev;
+	}
+
+	return count;
+}
+
+/* Bytes used by the compressed adjacency (offsets included). */
+unsigned long
+vcsr_get_bytes(vcsr_graph_t* vcsr)
+{
+	if (!vcsr)
+		return 0;
+
+	return vcsr->offsets[vcsr->nodes]
+		+ (vcsr->nodes + 1) * sizeof(*vcsr->offsets);
+}
+
+void
+vcsr_free(vcsr_graph_t* vcsr)
+{
+	if (!vcsr)
+		return;
+
+	free(vcsr->offsets);
+	free(vcsr->data);
+	free(vcsr);
+}
+
+
+
+// ------------------- CHEAT SHEET START HERE -------------------
+
+void BFS(list_graph_t* graph, int start_node, int *color) {
+    int_queue_t q;
+    int node;
+
+    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return;
+
+    int_queue_init(&q, graph->nodes);
+    int_queue_push(&q, start_node);
+
+    while (!int_queue_is_empty(&q)) {
+        node = int_queue_pop(&q);
+        LG_STAT_ADD(nodes_dequeued, 1);
+
+        // un nod poate fi în coadă de mai multe ori, îl procesăm o singură dată
+        if (color[node])
+            continue;
+        color[node] = 1;  // Mark the node as visited
+
+        linked_list_t *neighbours = lg_get_neighbours(graph, node);
+        ll_node_t *crt = neighbours->head;
+
+        while (crt) {
+            LG_STAT_ADD(edges_scanned, 1);
+            if (!color[*(int *)crt->data]) {
+                int_queue_push(&q, *(int *)crt->data);
+            }
+            crt = crt->next;
+        }
+    }
+
+    int_queue_destroy(&q);
+}
+
+/*
+ * Context de parcurgere refolosibil între apeluri: vectorii per nod și coada
+ * se alocă o singură dată, iar "golirea" lor e doar ++epoch (un nod e atins
+ * în parcurgerea curentă dacă stamp[v] == epoch). O interogare mică pe un
+ * graf mare costă cât atinge, nu cât graph->nodes.
+ */
+typedef struct {
+    int nodes;
+    unsigned int epoch;
+    unsigned int *stamp;
+    int *dist;          // valid doar unde stamp[v] == epoch
+    int_queue_t q;
+} lg_trav_t;
+
+lg_trav_t *lg_trav_create(int nodes) {
+    lg_trav_t *t = calloc(1, sizeof(*t));
+    DIE(!t, "calloc traversal context failed");
+
+    t->nodes = nodes;
+    t->stamp = calloc(nodes ? nodes : 1, sizeof(unsigned int));
+    t->dist = malloc((nodes ? nodes : 1) * sizeof(int));
+    DIE(!t->stamp || !t->dist, "alloc traversal context failed");
+    LG_STAT_ADD(mallocs, 3);
+    int_queue_init(&t->q, 0);
+    return t;
+}
+
+void lg_trav_free(lg_trav_t *t) {
+    if (!t)
+        return;
+
+    int_queue_destroy(&t->q);
+    free(t->stamp);
+    free(t->dist);
+    free(t);
+    LG_STAT_ADD(frees, 3);
+}
+
+// pregătește o parcurgere nouă pe un graf cu n noduri
+static void lg_trav_begin(lg_trav_t *t, int n) {
+    if (n > t->nodes) {
+        t->stamp = realloc(t->stamp, n * sizeof(unsigned int));
+        t->dist = realloc(t->dist, n * sizeof(int));
+        DIE(!t->stamp || !t->dist, "realloc traversal context failed");
+        LG_STAT_ADD(mallocs, 2);
+        LG_STAT_ADD(frees, 2);
+        memset(t->stamp + t->nodes, 0, (n - t->nodes) * sizeof(unsigned int));
+        t->nodes = n;
+    }
+    // la overflow ștampilele vechi ar putea părea noi: le ștergem o dată la 2^32
+    if (++t->epoch == 0) {
+        memset(t->stamp, 0, t->nodes * sizeof(unsigned int));
+        t->epoch = 1;
+    }
+    int_queue_clear(&t->q);
+}
+
+static inline int lg_trav_seen(const lg_trav_t *t, int v) {
+    return t->stamp[v] == t->epoch;
+}
+
+static inline void lg_trav_mark(lg_trav_t *t, int v, int dist) {
+    t->stamp[v] = t->epoch;
+    t->dist[v] = dist;
+}
+
+// distanța lui node în ultima parcurgere făcută cu t, -1 dacă n-a fost atins
+int lg_trav_dist(const lg_trav_t *t, int node) {
+    if (!t || node < 0 || node >= t->nodes || !lg_trav_seen(t, node))
+        return -1;
+    return t->dist[node];
+}
+
+/*
+ * Contextul funcțiilor care nu primesc unul (print_k_BFS_level,
+ * shortest_path_BFS, ...): câte unul per thread, crescut după nevoie și păstrat
+ * între apeluri, eliberat de cheia pthread când thread-ul iese. Un apel făcut
+ * dintr-un visitor cât timp e ocupat primește un context temporar.
+ */
+static pthread_key_t lg_trav_key;
+static pthread_once_t lg_trav_once = PTHREAD_ONCE_INIT;
+static __thread int lg_trav_tls_busy;
+
+static void lg_trav_key_free(void *t) {
+    lg_trav_free(t);
+}
+
+static void lg_trav_key_init(void) {
+    DIE(pthread_key_create(&lg_trav_key, lg_trav_key_free), "pthread_key_create");
+}
+
+static lg_trav_t *lg_trav_acquire(void) {
+    if (lg_trav_tls_busy)
+        return lg_trav_create(0);
+
+    pthread_once(&lg_trav_once, lg_trav_key_init);
+    lg_trav_t *t = pthread_getspecific(lg_trav_key);
+    if (!t) {
+        t = lg_trav_create(0);
+        DIE(pthread_setspecific(lg_trav_key, t), "pthread_setspecific");
+    }
+    lg_trav_tls_busy = 1;
+    return t;
+}
+
+static void lg_trav_release(lg_trav_t *t) {
+    if (lg_trav_tls_busy && t == pthread_getspecific(lg_trav_key))
+        lg_trav_tls_busy = 0;
+    else
+        lg_trav_free(t);
+}
+
+/*
+ * Eliberează acum contextul thread-ului curent. Pentru thread-ul principal,
+ * care nu trece prin destructorul cheii, și după interogări pe grafuri mari.
+ */
+void lg_trav_local_free(void) {
+    if (lg_trav_tls_busy)
+        return;
+
+    pthread_once(&lg_trav_once, lg_trav_key_init);
+    lg_trav_free(pthread_getspecific(lg_trav_key));
+    pthread_setspecific(lg_trav_key, NULL);
+}
+
+/*
+ * Parcurgeri fără printf: un visitor primește fiecare nod cu nivelul lui (la
+ * DFS, adâncimea în arborele DFS) și oprește parcurgerea întorcând != 0.
+ * Funcțiile de afișare de mai jos sunt construite peste ele.
+ */
+typedef int (*lg_visit_fn)(int node, int level, void *arg);
+
+// parent[v] e scris doar pentru nodurile descoperite (nu și pentru start_node)
+static inline int bfs_core(lg_trav_t *t, list_graph_t *graph, int start_node, int max_level,
+                           int *order, int *parent, lg_visit_fn visit, void *arg) {
+    int count = 0, depth = 0, stop = 0;
+
+    lg_trav_begin(t, graph->nodes);
+    int_queue_push(&t->q, start_node);
+    lg_trav_mark(t, start_node, 0);
+
+    while (!int_queue_is_empty(&t->q) && !stop) {
+        int level_size = int_queue_size(&t->q);
+        LG_STAT_LEVEL_BEGIN(level_t0);
+
+        for (int i = 0; i < level_size; i++) {
+            int node = int_queue_pop(&t->q);
+            LG_STAT_ADD(nodes_dequeued, 1);
+
+            if (order)
+                order[count] = node;
+            count++;
+            if (visit && visit(node, depth, arg)) {
+                stop = 1;
+                break;
+            }
+            // vecinii nodurilor de pe ultimul nivel cerut nu ne mai interesează
+            if (depth == max_level)
+                continue;
+
+            for (ll_node_t *crt = graph->neighbors[node]->head; crt; crt = crt->next) {
+                int v = *(int *)crt->data;
+                LG_STAT_ADD(edges_scanned, 1);
+                if (!lg_trav_seen(t, v)) {
+                    lg_trav_mark(t, v, depth + 1);
+                    if (parent)
+                        parent[v] = node;
+                    int_queue_push(&t->q, v);
+                }
+            }
+        }
+
+        LG_STAT_LEVEL_END(level_t0, depth, level_size);
+        depth++;
+    }
+
+    return count;
+}
+
+typedef struct {
+    int node;
+    int parent;
+    int depth;
+} dfs_item_t;
+
+LG_DEFINE_STACK(dfs_item, dfs_item_t)
+
+static inline int dfs_core(list_graph_t *graph, int start_node, int *color, int *order,
+                           int *parent, lg_visit_fn visit, void *arg) {
+    int count = 0;
+    dfs_item_stack_t st;
+    dfs_item_stack_init(&st, graph->nodes);
+    dfs_item_stack_push(&st, (dfs_item_t){ start_node, -1, 0 });
+
+    while (!dfs_item_stack_is_empty(&st)) {
+        dfs_item_t item = dfs_item_stack_pop(&st);
+        LG_STAT_ADD(nodes_dequeued, 1);
+
+        if (color[item.node])
+            continue;
+
+        color[item.node] = 1;  // Mark the node as visited
+        if (order)
+            order[count] = item.node;
+        if (parent)
+            parent[item.node] = item.parent;
+        count++;
+        if (visit && visit(item.node, item.depth, arg))
+            break;
+
+        for (ll_node_t *crt = graph->neighbors[item.node]->head; crt; crt = crt->next) {
+            int v = *(int *)crt->data;
+            LG_STAT_ADD(edges_scanned, 1);
+            if (!color[v])
+                dfs_item_stack_push(&st, (dfs_item_t){ v, item.node, item.depth + 1 });
+        }
+    }
+
+    dfs_item_stack_destroy(&st);
+    return count;
+}
+
+/*
+ * BFS cu rezultatele în vectori: order[i] = al i-lea nod vizitat, level[v] și
+ * parent[v] (-1 pentru nodurile neatinse și pentru parent[start_node]). Se
+ * opresc după nivelul max_level (max_level < 0 = fără limită). Oricare dintre
+ * vectori poate fi NULL. Întoarce numărul de noduri vizitate. level și parent
+ * se completează pe toate nodurile, deci costă O(graph->nodes); fără ele
+ * costul e cât atinge parcurgerea.
+ */
+int lg_bfs(list_graph_t *graph, int start_node, int max_level, int *order, int *level,
+           int *parent) {
+    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return 0;
+
+    if (parent)
+        for (int i = 0; i < graph->nodes; i++)
+            parent[i] = -1;
+
+    lg_trav_t *t = lg_trav_acquire();
+    int count = bfs_core(t, graph, start_node, max_level, order, parent, NULL, NULL);
+    if (level)
+        for (int i = 0; i < graph->nodes; i++)
+            level[i] = lg_trav_dist(t, i);
+    lg_trav_release(t);
+    return count;
+}
+
+// BFS care cheamă visit(nod, nivel, arg) pe fiecare nod, în ordinea lui lg_bfs
+int lg_bfs_visit(list_graph_t *graph, int start_node, int max_level, lg_visit_fn visit,
+                 void *arg) {
+    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return 0;
+
+    lg_trav_t *t = lg_trav_acquire();
+    int count = bfs_core(t, graph, start_node, max_level, NULL, NULL, visit, arg);
+    lg_trav_release(t);
+    return count;
+}
+
+/*
+ * Ca lg_bfs_visit, dar cu bufferele din t, fără nicio alocare după primul
+ * apel: costă cât atinge parcurgerea. order poate fi NULL; distanțele rămân în
+ * t până la următoarea parcurgere (lg_trav_dist).
+ */
+int lg_trav_bfs(lg_trav_t *t, list_graph_t *graph, int start_node, int max_level, int *order,
+                lg_visit_fn visit, void *arg) {
+    if (!t || !graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return 0;
+
+    return bfs_core(t, graph, start_node, max_level, order, NULL, visit, arg);
+}
+
+/*
+ * DFS iterativ, în ordinea lui DFS; color e marcat ca acolo. order[i] = al
+ * i-lea nod vizitat, parent[v] = nodul din care s-a ajuns în v (scris doar
+ * pentru nodurile vizitate acum, -1 pentru start_node). Întoarce numărul de
+ * noduri vizitate.
+ */
+int lg_dfs(list_graph_t *graph, int start_node, int *color, int *order, int *parent) {
+    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return 0;
+
+    return dfs_core(graph, start_node, color, order, parent, NULL, NULL);
+}
+
+int lg_dfs_visit(list_graph_t *graph, int start_node, int *color, lg_visit_fn visit,
+                 void *arg) {
+    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return 0;
+
+    return dfs_core(graph, start_node, color, NULL, NULL, visit, arg);
+}
+
+static int print_node_visit(int node, int level, void *arg) {
+    (void)level;
+    (void)arg;
+    printf("%d ", node);
+    return 0;
+}
+
+void DFS(list_graph_t* graph, int start_node, int *color) {
+    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return;
+
+    dfs_core(graph, start_node, color, NULL, NULL, print_node_visit, NULL);
+}
+
+static int print_level_k_visit(int node, int level, void *arg) {
+    if (level == *(int *)arg)
+        printf("%d ", node);
+    return 0;
+}
+
+void lg_trav_print_k_BFS_level(lg_trav_t *t, list_graph_t *graph, int start_node, int k)
+{
+    if (!t || !graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes || k < 0)
+        return;
+
+    bfs_core(t, graph, start_node, k, NULL, NULL, print_level_k_visit, &k);
+    printf("\n");
+}
+
+void print_k_BFS_level(list_graph_t *graph, int start_node, int k)
+{
+    lg_trav_t *t = lg_trav_acquire();
+    lg_trav_print_k_BFS_level(t, graph, start_node, k);
+    lg_trav_release(t);
+}
+
+// câte un rând pe nivel: trecem la rând nou când se schimbă nivelul
+static int print_levels_visit(int node, int level, void *arg) {
+    int *crt_level = arg;
+
+    if (level != *crt_level) {
+        printf("\n");
+        *crt_level = level;
+    }
+    printf("%d ", node);
+    return 0;
+}
+
+void lg_trav_print_BFS_levels(lg_trav_t *t, list_graph_t *graph, int start_node)
+{
+    if (!t || !graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+        return;
+
+    int crt_level = 0;
+    bfs_core(t, graph, start_node, -1, NULL, NULL, print_levels_visit, &crt_level);
+    printf("\n");
+}
+
+void print_BFS_levels(list_graph_t* graph, int start_node)
+{
+    lg_trav_t *t = lg_trav_acquire();
+    lg_trav_print_BFS_levels(t, graph, start_node);
+    lg_trav_release(t);
+}
+
+int path_exists(list_graph_t* graph, int src, int dest, int *visited) {
+    if (!graph || !graph->neighbors || src < 0 || src >= graph->nodes || dest < 0 || dest >= graph->nodes)
+        return 0;
+
+    if (src == dest)
+        return 1;
+
+    visited[src] = 1;
+
+    linked_list_t *neighbours = lg_get_neighbours(graph, src);
+    ll_node_t *crt = neighbours->head;
+
+    while (crt) {
+        int neighbour = *(int *)crt->data;
+        LG_STAT_ADD(edges_scanned, 1);
+        if (!visited[neighbour]) {
+            if (path_exists(graph, neighbour, dest, visited))
+                return 1;
+        }
+        crt = crt->next;
+    }
+
+    return 0;
+}
+
+void component_arrays(list_graph_t* graph, int *visited, int *component, int node, int component_id) {
+    if (!graph || !graph->neighbors || node < 0 || node >= graph->nodes || visited[node])
+        return;
+
+    visited[node] = 1;
+    component[node] = component_id;
+
+    linked_list_t *neighbours = lg_get_neighbours(graph, node);
+    ll_node_t *crt = neighbours->head;
+
+    while (crt) {
+        int neighbour = *(int *)crt->data;
+        LG_STAT_ADD(edges_scanned, 1);
+        if (!visited[neighbour]) {
+            component_arrays(graph, visited, component, neighbour, component_id);
+        }
+        crt = crt->next;
+    }
+}
+
+// ca shortest_path_BFS, dar refolosește bufferele din t
+int lg_trav_shortest_path(lg_trav_t *t, list_graph_t *graph, int start, int target)
+{
+    if (!t || !graph || start < 0 || target < 0 ||
+        start >= graph->nodes || target >= graph->nodes)
+        return -1;
+
+    lg_trav_begin(t, graph->nodes);
+    int_queue_push(&t->q, start);
+    lg_trav_mark(t, start, 0);
+
+    while (!int_queue_is_empty(&t->q)) {
+        int node = int_queue_pop(&t->q);
+        LG_STAT_ADD(nodes_dequeued, 1);
+
+        if (node == target)
+            return t->dist[node];
+
+        linked_list_t *neigh = lg_get_neighbours(graph, node);
+        ll_node_t *crt = neigh->head;
+        while (crt) {
+            int v = *(int *)crt->data;
+            LG_STAT_ADD(edges_scanned, 1);
+            if (!lg_trav_seen(t, v)) {
+                lg_trav_mark(t, v, t->dist[node] + 1);
+                int_queue_push(&t->q, v);
+            }
+            crt = crt->next;
+        }
+    }
+
+    return -1; // dacă target nu e accesibil
+}
+
+int shortest_path_BFS(list_graph_t *graph, int start, int target)
+{
+    if (!graph || start < 0 || target < 0 ||
+        start >= graph->nodes || target >= graph->nodes)
+        return -1;
+
+    lg_trav_t *t = lg_trav_acquire();
+    int result = lg_trav_shortest_path(t, graph, start, target);
+    lg_trav_release(t);
+    return result;
+}
+
+void dfs_order(list_graph_t *graph, int node, int *visited, int *stack, int *stack_top) {
+    visited[node] = 1;
+    linked_list_t *neigh = lg_get_neighbours(graph, node);
+    for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
+        int v = *(int *)crt->data;
+        LG_STAT_ADD(edges_scanned, 1);
+        if (!visited[v])
+            dfs_order(graph, v, visited, stack, stack_top);
+    }
+    stack[(*stack_top)++] = node;
+}
+
+list_graph_t* transpose_graph(list_graph_t *graph) {
+    list_graph_t *t_graph = lg_create(graph->nodes);
+    for (int u = 0; u < graph->nodes; u++) {
+        linked_list_t *neigh = lg_get_neighbours(graph, u);
+        for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
+            int v = *(int *)crt->data;
+            lg_add_edge(t_graph, v, u);  // inversăm direcția
+        }
+    }
+    return t_graph;
+}
+
+void dfs_assign(list_graph_t *graph, int node, int *visited, int *component, int comp_id) {
+    visited[node] = 1;
+    component[node] = comp_id;
+    linked_list_t *neigh = lg_get_neighbours(graph, node);
+    for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
+        int v = *(int *)crt->data;
+        LG_STAT_ADD(edges_scanned, 1);
+        if (!visited[v])
+            dfs_assign(graph, v, visited, component, comp_id);
+    }
+}
+
+#define SCC_DONE INT_MAX
+
+// Memoria de lucru pentru Tarjan iterativ, câte un element pe nod
+typedef struct {
+    int *index;
+    int *low;           // SCC_DONE după ce nodul are componentă
+    int *stack;         // stiva lui Tarjan
+    int top;
+    int *frames;        // stiva de apeluri, în locul recursivității
+    ll_node_t **cursor; // următorul vecin de vizitat pentru fiecare nod
+    int counter;
+} scc_work_t;
+
+static void scc_work_init(scc_work_t *w, int n) {
+    w->index = malloc(n * sizeof(int));
+    w->low = malloc(n * sizeof(int));
+    w->stack = malloc(n * sizeof(int));
+    w->frames = malloc(n * sizeof(int));
+    w->cursor = malloc(n * sizeof(ll_node_t *));
+    DIE(!w->index || !w->low || !w->stack || !w->frames || !w->cursor, "malloc scc buffers failed");
+    w->top = 0;
+    w->counter = 0;
+}
+
+static void scc_work_free(scc_work_t *w) {
+    free(w->index);
+    free(w->low);
+    free(w->stack);
+    free(w->frames);
+    free(w->cursor);
+}
+
+/*
+ * Tarjan iterativ pornind din root. Componentele primesc id-uri de la
+ * *num_components în sus, în ordine topologică inversă (întâi cele din care nu
+ * se mai iese). Dacă filter != NULL, se merge doar pe nodurile cu
+ * filter[v] == filter_id. index[v] trebuie să fie -1 pentru nodurile încă
+ * nevizitate.
+ */
+static void tarjan_visit(list_graph_t *graph, int root, const int *filter, int filter_id,
+                         scc_work_t *w, int *component, int *num_components) {
+    int depth = 0;
+
+    w->index[root] = w->low[root] = w->counter++;
+    w->stack[w->top++] = root;
+    w->frames[depth++] = root;
+    w->cursor[root] = graph->neighbors[root]->head;
+
+    while (depth) {
+        int u = w->frames[depth - 1];
+        ll_node_t *crt = w->cursor[u];
+
+        if (crt) {
+            int v = *(int *)crt->data;
+            w->cursor[u] = crt->next;
+            LG_STAT_ADD(edges_scanned, 1);
+
+            if (filter && filter[v] != filter_id)
+                continue;
+
+            if (w->index[v] < 0) {
+                w->index[v] = w->low[v] = w->counter++;
+                w->stack[w->top++] = v;
+                w->frames[depth++] = v;
+                w->cursor[v] = graph->neighbors[v]->head;
+            } else if (w->low[v] != SCC_DONE && w->index[v] < w->low[u]) {
+                w->low[u] = w->index[v];  // v e încă pe stivă
+            }
+            continue;
+        }
+
+        // "revenirea" din apelul pentru u
+        depth--;
+        LG_STAT_ADD(nodes_dequeued, 1);
+        if (depth && w->low[u] < w->low[w->frames[depth - 1]])
+            w->low[w->frames[depth - 1]] = w->low[u];
+
+        if (w->low[u] == w->index[u]) {
+            int v;
+            do {
+                v = w->stack[--w->top];
+                w->low[v] = SCC_DONE;
+                component[v] = *num_components;
+            } while (v != u);
+            (*num_components)++;
+        }
+    }
+}
+
+/*
+ * Tarjan cu stivă explicită: o singură trecere, O(V) memorie în plus și fără
+ * graf transpus. Componentele sunt numerotate în ordine topologică (de la
+ * sursă spre destinație), ca la varianta Kosaraju de mai sus.
+ */
+void find_strongly_connected_components(list_graph_t *graph, int *component, int *num_components) {
+    int n = graph->nodes;
+    scc_work_t w;
+
+    scc_work_init(&w, n);
+    for (int i = 0; i < n; i++)
+        w.index[i] = -1;
+
+    *num_components = 0;
+    for (int i = 0; i < n; i++) {
+        if (w.index[i] < 0)
+            tarjan_visit(graph, i, NULL, 0, &w, component, num_components);
+    }
+
+    // Tarjan le dă în ordine inversă
+    for (int i = 0; i < n; i++)
+        component[i] = *num_components - 1 - component[i];
+
+    scc_work_free(&w);
+}
+
+void topological_sort(list_graph_t *graph, int *visited, int *stack, int *stack_top, int node) {
+    visited[node] = 1;
+    linked_list_t *neigh = lg_get_neighbours(graph, node);
+    for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
+        int v = *(int *)crt->data;
+        LG_STAT_ADD(edges_scanned, 1);
+        if (!visited[v])
+            topological_sort(graph, visited, stack, stack_top, v);
+    }
+    stack[(*stack_top)++] = node;
+}
+
+
+// ------------------- CSR (lg_freeze) VARIANTS -------------------
+
+void csr_BFS(csr_graph_t *graph, int start_node, int *color) {
+    int *queue;
+    int head = 0, tail = 0;
+
+    if (!graph || start_node < 0 || start_node >= graph->nodes)
+        return;
+
+    queue = malloc(graph->nodes * sizeof(int));
+    DIE(!queue, "malloc queue failed");
+
+    queue[tail++] = start_node;
+    color[start_node] = 1;
+
+    while (head != tail) {
+        int node = queue[head++];
+        LG_STAT_ADD(nodes_dequeued, 1);
+
+        for (unsigned int e = graph->offsets[node]; e != graph->offsets[node + 1]; e++) {
+            int v = graph->adj[e];
+            LG_STAT_ADD(edges_scanned, 1);
+            if (!color[v]) {
+                color[v] = 1;
+                queue[tail++] = v;
+            }
+        }
+    }
+
+    free(queue);
+}
+
+void csr_DFS(csr_graph_t *graph, int start_node, int *color) {
+    int_stack_t st;
+
+    if (!graph || start_node < 0 || start_node >= graph->nodes)
+        return;
+
+    int_stack_init(&st, graph->nodes);
+    int_stack_push(&st, start_node);
+
+    while (!int_stack_is_empty(&st)) {
+        int node = int_stack_pop(&st);
+        LG_STAT_ADD(nodes_dequeued, 1);
+
+        if (color[node])
+            continue;
+
+        color[node] = 1;  // Mark the node as visited
+        printf("%d ", node);
+
+        // toată lista de vecini dintr-un memcpy; cei deja vizitați se sar la pop
+        unsigned int first = graph->offsets[node];
+        LG_STAT_ADD(edges_scanned, graph->offsets[node + 1] - first);
+        int_stack_push_range(&st, graph->adj + first, graph->offsets[node + 1] - first);
+    }
+
+    int_stack_destroy(&st);
+}
+
+int csr_shortest_path_BFS(csr_graph_t *graph, int start, int target)
+{
+    if (!graph || start < 0 || target < 0 ||
+        start >= graph->nodes || target >= graph->nodes)
+        return -1;
+
+    int *dist = malloc(graph->nodes * sizeof(int));
+    int *queue = malloc(graph->nodes * sizeof(int));
+    DIE(!dist || !queue, "malloc bfs buffers failed");
+    memset(dist, -1, graph->nodes * sizeof(int));
+
+    int head = 0, tail = 0, result = -1;
+    queue[tail++] = start;
+    dist[start] = 0;
+
+    while (head != tail) {
+        int node = queue[head++];
+        LG_STAT_ADD(nodes_dequeued, 1);
+
+        if (node == target) {
+            result = dist[node];
+            break;
+        }
+
+        for (unsigned int e = graph->offsets[node]; e != graph->offsets[node + 1]; e++) {
+            int v = graph->adj[e];
+            LG_STAT_ADD(edges_scanned, 1);
+            if (dist[v] < 0) {
+                dist[v] = dist[node] + 1;
+                queue[tail++] = v;
+            }
+        }
+    }
+
+    free(queue);
+    free(dist);
+    return result;
+}
+
+/*
+ * DFS iterativ care pune nodurile pe `stack` în postordine, exact ca
+ * dfs_order / topological_sort. `frames` și `cursor` au graph->nodes elemente
+ * și nu trebuie inițializate.
+ */
+static void csr_dfs_postorder(csr_graph_t *graph, int root, int *visited, int *stack,
+                              int *stack_top, int *frames, unsigned int *cursor) {
+    int depth = 0;
+
+    visited[root] = 1;
+    frames[depth++] = root;
+    cursor[root] = graph->offsets[root];
+
+    while (depth) {
+        int node = frames[depth - 1];
+
+        if (cursor[node] != graph->offsets[node + 1]) {
+            int v = graph->adj[cursor[node]++];
+            LG_STAT_ADD(edges_scanned, 1);
+            if (!visited[v]) {
+                visited[v] = 1;
+                cursor[v] = graph->offsets[v];
+                frames[depth++] = v;
+            }
+            continue;
+        }
+
+        stack[(*stack_top)++] = node;
+        depth--;
+        LG_STAT_ADD(nodes_dequeued, 1);
+    }
+}
+
+// Tarjan iterativ, la fel ca find_strongly_connected_components
+void csr_find_strongly_connected_components(csr_graph_t *graph, int *component, int *num_components) {
+    int n = graph->nodes;
+    int *index = malloc(n * sizeof(int));
+    int *low = malloc(n * sizeof(int));
+    int *stack = malloc(n * sizeof(int));
+    int *frames = malloc(n * sizeof(int));
+    unsigned int *cursor = malloc(n * sizeof(unsigned int));
+    int counter = 0, top = 0;
+    DIE(!index || !low || !stack || !frames || !cursor, "malloc scc buffers failed");
+
+    for (int i = 0; i < n; i++)
+        index[i] = -1;
+    *num_components = 0;
+
+    for (int root = 0; root < n; root++) {
+        int depth = 0;
+
+        if (index[root] >= 0)
+            continue;
+
+        index[root] = low[root] = counter++;
+        stack[top++] = root;
+        frames[depth++] = root;
+        cursor[root] = graph->offsets[root];
+
+        while (depth) {
+            int u = frames[depth - 1];
+
+            if (cursor[u] != graph->offsets[u + 1]) {
+                int v = graph->adj[cursor[u]++];
+                LG_STAT_ADD(edges_scanned, 1);
+                if (index[v] < 0) {
+                    index[v] = low[v] = counter++;
+                    stack[top++] = v;
+                    frames[depth++] = v;
+                    cursor[v] = graph->offsets[v];
+                } else if (low[v] != SCC_DONE && index[v] < low[u]) {
+                    low[u] = index[v];
+                }
+                continue;
+            }
+
+            depth--;
+            LG_STAT_ADD(nodes_dequeued, 1);
+            if (depth && low[u] < low[frames[depth - 1]])
+                low[frames[depth - 1]] = low[u];
+
+            if (low[u] == index[u]) {
+                int v;
+                do {
+                    v = stack[--top];
+                    low[v] = SCC_DONE;
+                    component[v] = *num_components;
+                } while (v != u);
+                (*num_components)++;
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+        component[i] = *num_components - 1 - component[i];
+
+    free(cursor);
+    free(frames);
+    free(stack);
+    free(low);
+    free(index);
+}
+
+void csr_topological_sort(csr_graph_t *graph, int *visited, int *stack, int *stack_top, int node) {
+    // malloc fără inițializare: costă doar cât atinge DFS-ul
+    int *frames = malloc(graph->nodes * sizeof(int));
+    unsigned int *cursor = malloc(graph->nodes * sizeof(unsigned int));
+    DIE(!frames || !cursor, "malloc dfs buffers failed");
+
+    csr_dfs_postorder(graph, node, visited, stack, stack_top, frames, cursor);
+
+    free(cursor);
+    free(frames);
+}
+
+// Prag de comutare din Beamer et al., "Direction-Optimizing BFS"
+#define DO_BFS_ALPHA 15
+#define DO_BFS_BETA 18
+
+static unsigned long bfs_top_down_step(csr_graph_t *graph, int *frontier, int size, int *next,
+                                       int *next_size, int level, int *dist, int *parent,
+                                       unsigned long *inspected) {
+    unsigned long scout = 0;
+
+    *next_size = 0;
+    for (int i = 0; i < size; i++) {
+        int u = frontier[i];
+        *inspected += csr_get_degree(graph, u);
+        for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+            int v = graph->adj[e];
+            if (dist[v] < 0) {
+                dist[v] = level;
+                parent[v] = u;
+                next[(*next_size)++] = v;
+                scout += csr_get_degree(graph, v);
+            }
+        }
+    }
+
+    return scout;
+}
+
+static int bfs_bottom_up_step(csr_graph_t *t_graph, unsigned long *front, unsigned long *next,
+                              int level, int *dist, int *parent, unsigned long *inspected) {
+    int awake = 0;
+
+    memset(next, 0, BITMAP_WORDS(t_graph->nodes) * sizeof(unsigned long));
+    for (int v = 0; v < t_graph->nodes; v++) {
+        if (dist[v] >= 0)
+            continue;
+
+        for (unsigned int e = t_graph->offsets[v]; e != t_graph->offsets[v + 1]; e++) {
+            int u = t_graph->adj[e];
+            (*inspected)++;
+            if (bitmap_test(front, u)) {
+                dist[v] = level;
+                parent[v] = u;
+                bitmap_set(next, v);
+                awake++;
+                break;  // un singur părinte e destul
+            }
+        }
+    }
+
+    return awake;
+}
+
+/*
+ * BFS care alternează între pasul top-down (din frontieră spre vecini) și
+ * pasul bottom-up (fiecare nod nevizitat își caută un părinte în frontieră,
+ * pe graful transpus). Umple dist (-1 = inaccesibil) și parent
+ * (parent[start] = start) și întoarce numărul de muchii inspectate.
+ * t_graph e csr_transpose(graph); cu NULL rulează doar top-down.
+ */
+unsigned long csr_direction_optimizing_BFS(csr_graph_t *graph, csr_graph_t *t_graph, int start,
+                                           int *dist, int *parent) {
+    if (!graph || start < 0 || start >= graph->nodes)
+        return 0;
+
+    int n = graph->nodes;
+    int *frontier = malloc(n * sizeof(int));
+    int *next = malloc(n * sizeof(int));
+    unsigned long *front_bm = calloc(BITMAP_WORDS(n), sizeof(unsigned long));
+    unsigned long *next_bm = calloc(BITMAP_WORDS(n), sizeof(unsigned long));
+    DIE(!frontier || !next || !front_bm || !next_bm, "malloc bfs buffers failed");
+
+    for (int i = 0; i < n; i++) {
+        dist[i] = -1;
+        parent[i] = -1;
+    }
+    dist[start] = 0;
+    parent[start] = start;
+
+    unsigned long inspected = 0;
+    unsigned long edges_to_check = graph->edges;
+    unsigned long scout = csr_get_degree(graph, start);
+    int size = 1, level = 1;
+    frontier[0] = start;
+
+    while (size) {
+        if (t_graph && scout > edges_to_check / DO_BFS_ALPHA) {
+            // frontiera devine bitmap
+            memset(front_bm, 0, BITMAP_WORDS(n) * sizeof(unsigned long));
+            for (int i = 0; i < size; i++)
+                bitmap_set(front_bm, frontier[i]);
+
+            int awake = size, old_awake;
+            do {
+                old_awake = awake;
+                awake = bfs_bottom_up_step(t_graph, front_bm, next_bm, level++, dist, parent, &inspected);
+                unsigned long *tmp = front_bm;
+                front_bm = next_bm;
+                next_bm = tmp;
+            } while (awake && (awake >= old_awake || awake > n / DO_BFS_BETA));
+
+            // înapoi la coadă
+            size = 0;
+            for (int v = 0; v < n; v++)
+                if (bitmap_test(front_bm, v))
+                    frontier[size++] = v;
+            scout = 1;  // ca în GAP: nu comuta imediat înapoi
+            continue;
+        }
+
+        int next_size;
+        edges_to_check -= scout < edges_to_check ? scout : edges_to_check;
+        scout = bfs_top_down_step(graph, frontier, size, next, &next_size, level++, dist, parent,
+                                  &inspected);
+
+        int *tmp = frontier;
+        frontier = next;
+        next = tmp;
+        size = next_size;
+    }
+
+    free(next_bm);
+    free(front_bm);
+    free(next);
+    free(frontier);
+    return inspected;
+}
+
+#define PAR_BFS_CHUNK 64
+#define PAR_BFS_LOCAL 1024
+
+typedef struct {
+    csr_graph_t *graph;
+    int *dist;
+    int *order;         // nodurile, nivel după nivel
+    int *level_start;
+    int levels;
+    unsigned int begin; // frontiera curentă e order[begin, end)
+    unsigned int end;
+    unsigned int cursor;
+    unsigned int tail;
+    pthread_barrier_t barrier;
+} par_bfs_t;
+
+typedef struct {
+    par_bfs_t *shared;
+    int tid;
+} par_bfs_arg_t;
+
+static void par_bfs_flush(par_bfs_t *b, int *local, int *count) {
+    unsigned int pos = __atomic_fetch_add(&b->tail, *count, __ATOMIC_RELAXED);
+    memcpy(b->order + pos, local, *count * sizeof(int));
+    *count = 0;
+}
+
+static void *par_bfs_worker(void *arg) {
+    par_bfs_arg_t *a = arg;
+    par_bfs_t *b = a->shared;
+    csr_graph_t *graph = b->graph;
+    int local[PAR_BFS_LOCAL];
+    int count = 0;
+
+    for (;;) {
+        int level = b->levels;  // nivelul vecinilor descoperiți acum
+        unsigned int end = b->end, i;
+
+        while ((i = __atomic_fetch_add(&b->cursor, PAR_BFS_CHUNK, __ATOMIC_RELAXED)) < end) {
+            unsigned int stop = i + PAR_BFS_CHUNK < end ? i + PAR_BFS_CHUNK : end;
+
+            for (; i < stop; i++) {
+                int u = b->order[i];
+                for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+                    int v = graph->adj[e];
+                    int unvisited = -1;
+
+                    if (__atomic_load_n(&b->dist[v], __ATOMIC_RELAXED) >= 0)
+                        continue;
+                    // doar un thread câștigă nodul
+                    if (!__atomic_compare_exchange_n(&b->dist[v], &unvisited, level, 0,
+                                                     __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                        continue;
+
+                    local[count++] = v;
+                    if (count == PAR_BFS_LOCAL)
+                        par_bfs_flush(b, local, &count);
+                }
+            }
+        }
+        if (count)
+            par_bfs_flush(b, local, &count);
+
+        pthread_barrier_wait(&b->barrier);
+        if (a->tid == 0) {
+            b->begin = b->end;
+            b->end = b->tail;
+            b->cursor = b->begin;
+            if (b->begin != b->end)
+                b->level_start[b->levels++] = b->begin;
+        }
+        pthread_barrier_wait(&b->barrier);
+
+        if (b->begin == b->end)
+            break;
+    }
+
+    return NULL;
+}
+
+/*
+ * BFS paralel, sincronizat pe niveluri: fiecare nivel e împărțit în bucăți
+ * între threads, un nod e revendicat cu CAS pe dist, iar nodurile noi se
+ * adună în buffere locale și se copiază în `order` la finalul bucății.
+ * dist iese identic cu shortest_path_BFS (-1 = inaccesibil). Dacă nu sunt NULL,
+ * `order` (graph->nodes elemente) primește nodurile grupate pe niveluri, iar
+ * nivelul k e order[level_start[k]] ... order[level_start[k + 1] - 1]
+ * (level_start are graph->nodes + 1 elemente); mulțimile sunt aceleași ca la
+ * print_BFS_levels, ordinea din interiorul unui nivel nu. Întoarce numărul de
+ * niveluri.
+ */
+int csr_parallel_BFS(csr_graph_t *graph, int start, int threads, int *dist, int *order,
+                     int *level_start) {
+    if (!graph || start < 0 || start >= graph->nodes)
+        return 0;
+    if (threads < 1)
+        threads = 1;
+
+    int n = graph->nodes;
+    par_bfs_t b;
+    par_bfs_arg_t *args = malloc(threads * sizeof(*args));
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    int *own_order = order ? NULL : malloc(n * sizeof(int));
+    int *own_start = level_start ? NULL : malloc((n + 1) * sizeof(int));
+    DIE(!args || !tids || (!order && !own_order) || (!level_start && !own_start),
+        "malloc parallel bfs buffers failed");
+
+    for (int i = 0; i < n; i++)
+        dist[i] = -1;
+    dist[start] = 0;
+
+    b.graph = graph;
+    b.dist = dist;
+    b.order = order ? order : own_order;
+    b.level_start = level_start ? level_start : own_start;
+    b.order[0] = start;
+    b.level_start[0] = 0;
+    b.levels = 1;
+    b.begin = b.cursor = 0;
+    b.end = b.tail = 1;
+    DIE(pthread_barrier_init(&b.barrier, NULL, threads), "pthread_barrier_init");
+
+    for (int t = 0; t < threads; t++) {
+        args[t].shared = &b;
+        args[t].tid = t;
+    }
+    for (int t = 1; t < threads; t++)
+        DIE(pthread_create(tids + t, NULL, par_bfs_worker, args + t), "pthread_create");
+    par_bfs_worker(args);
+    for (int t = 1; t < threads; t++)
+        pthread_join(tids[t], NULL);
+
+    b.level_start[b.levels] = b.end;
+
+    pthread_barrier_destroy(&b.barrier);
+    free(own_start);
+    free(own_order);
+    free(tids);
+    free(args);
+    return b.levels;
+}
+
+// vector de int care crește singur, pentru bufferele locale ale thread-urilor
+typedef struct {
+    int *data;
+    unsigned int size;
+    unsigned int cap;
+} int_buf_t;
+
+static void int_buf_push(int_buf_t *b, int x) {
+    if (b->size == b->cap) {
+        b->cap = b->cap ? 2 * b->cap : 256;
+        b->data = realloc(b->data, b->cap * sizeof(int));
+        DIE(!b->data, "realloc int_buf failed");
+    }
+    b->data[b->size++] = x;
+}
+
+#define PAR_SCC_TRIM_ROUNDS 3
+
+typedef struct {
+    csr_graph_t *graph;
+    csr_graph_t *t_graph;
+    int threads;
+    int *comp;          // -1 cât timp nodul nu are componentă
+    int *color;
+    int *active;        // nodurile fără componentă, compactate după fiecare rundă
+    int n_active;
+    int *roots;
+    unsigned int n_roots;
+    unsigned int cursor;
+    int changed;
+    pthread_barrier_t barrier;
+} par_scc_t;
+
+typedef struct {
+    par_scc_t *shared;
+    int tid;
+} par_scc_arg_t;
+
+static int par_scc_has_active(csr_graph_t *graph, int *comp, int v) {
+    for (unsigned int e = graph->offsets[v]; e != graph->offsets[v + 1]; e++) {
+        int w = graph->adj[e];
+        if (w != v && __atomic_load_n(&comp[w], __ATOMIC_RELAXED) < 0)
+            return 1;
+    }
+    return 0;
+}
+
+// doar thread-ul 0, între două bariere
+static void par_scc_compact(par_scc_t *s) {
+    int k = 0;
+    for (int i = 0; i < s->n_active; i++)
+        if (s->comp[s->active[i]] < 0)
+            s->active[k++] = s->active[i];
+    s->n_active = k;
+}
+
+static void *par_scc_worker(void *arg) {
+    par_scc_arg_t *a = arg;
+    par_scc_t *s = a->shared;
+    int_buf_t work = { NULL, 0, 0 };
+    int *comp = s->comp, *color = s->color;
+
+    // 1. Trim: un nod fără vecini activi la intrare sau la ieșire e singur în componentă
+    for (int round = 0; round < PAR_SCC_TRIM_ROUNDS; round++) {
+        int begin = (long)s->n_active * a->tid / s->threads;
+        int end = (long)s->n_active * (a->tid + 1) / s->threads;
+
+        for (int i = begin; i < end; i++) {
+            int v = s->active[i];
+            if (!par_scc_has_active(s->graph, comp, v) || !par_scc_has_active(s->t_graph, comp, v)) {
+                __atomic_store_n(&comp[v], v, __ATOMIC_RELAXED);
+                __atomic_store_n(&s->changed, 1, __ATOMIC_RELAXED);
+            }
+        }
+
+        pthread_barrier_wait(&s->barrier);
+        int changed = s->changed;
+        pthread_barrier_wait(&s->barrier);
+        if (a->tid == 0) {
+            par_scc_compact(s);
+            s->changed = 0;
+        }
+        pthread_barrier_wait(&s->barrier);
+        if (!changed)
+            break;
+    }
+
+    // 2. Colorare: fiecare nod ia cel mai mare id care ajunge la el; un nod cu
+    //    color[r] == r e maximul din componenta lui, care e exact mulțimea
+    //    nodurilor de culoare r ce ajung înapoi la r
+    while (s->n_active) {
+        int begin = (long)s->n_active * a->tid / s->threads;
+        int end = (long)s->n_active * (a->tid + 1) / s->threads;
+
+        work.size = 0;
+        for (int i = begin; i < end; i++) {
+            color[s->active[i]] = s->active[i];
+            int_buf_push(&work, s->active[i]);
+        }
+        pthread_barrier_wait(&s->barrier);
+
+        // propagare asincronă: cine mărește o culoare își pune nodul în lucru
+        while (work.size) {
+            int u = work.data[--work.size];
+            int cu = __atomic_load_n(&color[u], __ATOMIC_RELAXED);
+
+            for (unsigned int e = s->graph->offsets[u]; e != s->graph->offsets[u + 1]; e++) {
+                int v = s->graph->adj[e];
+                if (comp[v] >= 0)
+                    continue;
+
+                int cv = __atomic_load_n(&color[v], __ATOMIC_RELAXED);
+                while (cv < cu) {
+                    if (__atomic_compare_exchange_n(&color[v], &cv, cu, 0,
+                                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                        int_buf_push(&work, v);
+                        break;
+                    }
+                }
+            }
+        }
+        pthread_barrier_wait(&s->barrier);
+
+        if (a->tid == 0) {
+            s->n_roots = 0;
+            for (int i = 0; i < s->n_active; i++)
+                if (color[s->active[i]] == s->active[i])
+                    s->roots[s->n_roots++] = s->active[i];
+            s->cursor = 0;
+        }
+        pthread_barrier_wait(&s->barrier);
+
+        // 3. BFS înapoi din fiecare rădăcină, doar pe nodurile de culoarea ei;
+        //    culorile sunt disjuncte, deci rădăcinile se pot împărți liber
+        unsigned int r;
+        while ((r = __atomic_fetch_add(&s->cursor, 1, __ATOMIC_RELAXED)) < s->n_roots) {
+            int root = s->roots[r];
+            unsigned int head = 0;
+
+            work.size = 0;
+            comp[root] = root;
+            int_buf_push(&work, root);
+            while (head < work.size) {
+                int u = work.data[head++];
+                for (unsigned int e = s->t_graph->offsets[u]; e != s->t_graph->offsets[u + 1]; e++) {
+                    int v = s->t_graph->adj[e];
+                    if (color[v] == root && comp[v] < 0) {
+                        comp[v] = root;
+                        int_buf_push(&work, v);
+                    }
+                }
+            }
+        }
+        work.size = 0;
+        pthread_barrier_wait(&s->barrier);
+
+        if (a->tid == 0)
+            par_scc_compact(s);
+        pthread_barrier_wait(&s->barrier);
+    }
+
+    free(work.data);
+    return NULL;
+}
+
+/*
+ * Componente tare conexe în paralel: câteva runde de trim, apoi runde de
+ * colorare (propagarea celui mai mare id înainte + BFS înapoi din fiecare
+ * rădăcină pe graful transpus). Componentele sunt unice, deci apartenența nu
+ * depinde de threads; id-urile sunt date în ordinea celui mai mic nod din
+ * fiecare componentă, ca să iasă la fel la fiecare rulare (spre deosebire de
+ * find_strongly_connected_components, nu sunt în ordine topologică).
+ * t_graph e csr_transpose(graph).
+ */
+void csr_parallel_strongly_connected_components(csr_graph_t *graph, csr_graph_t *t_graph, int threads,
+                                                int *component, int *num_components) {
+    if (!graph || !t_graph || t_graph->nodes != graph->nodes || !component || !num_components)
+        return;
+
+    int n = graph->nodes;
+    par_scc_t s;
+
+    if (threads < 1)
+        threads = 1;
+
+    s.graph = graph;
+    s.t_graph = t_graph;
+    s.threads = threads;
+    s.comp = component;
+    s.color = malloc((n ? n : 1) * sizeof(int));
+    s.active = malloc((n ? n : 1) * sizeof(int));
+    s.roots = malloc((n ? n : 1) * sizeof(int));
+    s.n_active = n;
+    s.changed = 0;
+    DIE(!s.color || !s.active || !s.roots, "malloc scc buffers failed");
+    DIE(pthread_barrier_init(&s.barrier, NULL, threads), "pthread_barrier_init");
+
+    for (int i = 0; i < n; i++) {
+        component[i] = -1;
+        s.active[i] = i;
+    }
+
+    par_scc_arg_t *args = malloc(threads * sizeof(*args));
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    DIE(!args || !tids, "malloc threads failed");
+    for (int t = 0; t < threads; t++) {
+        args[t].shared = &s;
+        args[t].tid = t;
+    }
+    for (int t = 1; t < threads; t++)
+        DIE(pthread_create(tids + t, NULL, par_scc_worker, args + t), "pthread_create");
+    par_scc_worker(args);
+    for (int t = 1; t < threads; t++)
+        pthread_join(tids[t], NULL);
+
+    // reprezentant -> 0, 1, 2, ... în ordinea primului nod; `color` devine harta
+    for (int i = 0; i < n; i++)
+        s.color[i] = -1;
+    *num_components = 0;
+    for (int i = 0; i < n; i++) {
+        int rep = component[i];
+        if (s.color[rep] < 0)
+            s.color[rep] = (*num_components)++;
+        component[i] = s.color[rep];
+    }
+
+    pthread_barrier_destroy(&s.barrier);
+    free(tids);
+    free(args);
+    free(s.roots);
+    free(s.active);
+    free(s.color);
+}
+
+#define MS_BFS_WIDTH 64
+
+/*
+ * Până la 64 de BFS-uri simultan (MS-BFS): bitul i din seen[v] / visit[v]
+ * spune dacă sursa i a ajuns la v / îl are în frontieră, deci fiecare muchie
+ * e parcursă o singură dată pentru toate sursele. Dacă targets != NULL, sursa
+ * i se oprește când ajunge la targets[i] și result[i] = distanța (sau -1).
+ * Dacă dist != NULL, dist[i * graph->nodes + v] = distanța de la sources[i]
+ * la v (sau -1); atunci nicio sursă nu se oprește devreme.
+ */
+static void ms_bfs_batch(csr_graph_t *graph, const int *sources, const int *targets, int count,
+                         int *result, int *dist, unsigned long long *seen,
+                         unsigned long long *visit, unsigned long long *next) {
+    int n = graph->nodes;
+    unsigned long long pending = 0;
+
+    memset(seen, 0, n * sizeof(*seen));
+    memset(visit, 0, n * sizeof(*visit));
+    memset(next, 0, n * sizeof(*next));
+
+    for (int i = 0; i < count; i++) {
+        if (targets)
+            result[i] = -1;
+        if (!is_node_in_graph(sources[i], n) || (targets && !is_node_in_graph(targets[i], n)))
+            continue;
+
+        seen[sources[i]] |= 1ull << i;
+        visit[sources[i]] |= 1ull << i;
+        pending |= 1ull << i;
+        if (dist)
+            dist[(long)i * n + sources[i]] = 0;
+    }
+
+    for (int level = 0; pending; level++) {
+        unsigned long long any = 0;
+
+        if (targets) {
+            for (int i = 0; i < count; i++) {
+                if ((pending >> i & 1) && (seen[targets[i]] >> i & 1)) {
+                    result[i] = level;
+                    pending &= ~(1ull << i);
+                }
+            }
+            if (!pending)
+                break;
+        }
+
+        for (int u = 0; u < n; u++) {
+            unsigned long long frontier = visit[u] & pending;
+            if (!frontier)
+                continue;
+            for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+                int v = graph->adj[e];
+                next[v] |= frontier & ~seen[v];
+            }
+        }
+
+        for (int v = 0; v < n; v++) {
+            unsigned long long fresh = next[v];
+            visit[v] = fresh;
+            next[v] = 0;
+            if (!fresh)
+                continue;
+
+            seen[v] |= fresh;
+            any |= fresh;
+            if (dist) {
+                for (; fresh; fresh &= fresh - 1)
+                    dist[(long)__builtin_ctzll(fresh) * n + v] = level + 1;
+            }
+        }
+
+        if (!any)
+            break;
+    }
+}
+
+/*
+ * dist primește count * graph->nodes valori: rândul i sunt distanțele de la
+ * sources[i]. Sursele se procesează câte 64 odată.
+ */
+void csr_multi_source_BFS(csr_graph_t *graph, const int *sources, int count, int *dist) {
+    int n = graph->nodes;
+    unsigned long long *seen = malloc(n * sizeof(*seen));
+    unsigned long long *visit = malloc(n * sizeof(*visit));
+    unsigned long long *next = malloc(n * sizeof(*next));
+    DIE(!seen || !visit || !next, "malloc ms-bfs buffers failed");
+
+    for (long i = 0; i < (long)count * n; i++)
+        dist[i] = -1;
+
+    for (int i = 0; i < count; i += MS_BFS_WIDTH) {
+        int batch = count - i < MS_BFS_WIDTH ? count - i : MS_BFS_WIDTH;
+        ms_bfs_batch(graph, sources + i, NULL, batch, NULL, dist + (long)i * n, seen, visit, next);
+    }
+
+    free(next);
+    free(visit);
+    free(seen);
+}
+
+// result[i] = shortest_path_BFS(graph, starts[i], targets[i]), câte 64 odată
+void csr_batch_shortest_path_BFS(csr_graph_t *graph, const int *starts, const int *targets, int count,
+                                 int *result) {
+    int n = graph->nodes;
+    unsigned long long *seen = malloc(n * sizeof(*seen));
+    unsigned long long *visit = malloc(n * sizeof(*visit));
+    unsigned long long *next = malloc(n * sizeof(*next));
+    DIE(!seen || !visit || !next, "malloc ms-bfs buffers failed");
+
+    for (int i = 0; i < count; i += MS_BFS_WIDTH) {
+        int batch = count - i < MS_BFS_WIDTH ? count - i : MS_BFS_WIDTH;
+        ms_bfs_batch(graph, starts + i, targets + i, batch, result + i, NULL, seen, visit, next);
+    }
+
+    free(next);
+    free(visit);
+    free(seen);
+}
+
+/*
+ * Un nivel complet din partea `graph` (înainte) sau `t_graph` (înapoi).
+ * Întoarce suma gradelor noii frontiere, folosită ca să alegem partea care se
+ * extinde mai ieftin; *best / *meet se actualizează când atingem un nod văzut
+ * deja din partea cealaltă.
+ */
+static unsigned long bidir_expand(csr_graph_t *graph, int *queue, int *head, int *tail, int *dist,
+                                  int *parent, const int *other_dist, int *best, int *meet) {
+    unsigned long degrees = 0;
+    int end = *tail;
+
+    for (; *head < end; (*head)++) {
+        int u = queue[*head];
+        for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+            int v = graph->adj[e];
+            if (dist[v] >= 0)
+                continue;
+
+            dist[v] = dist[u] + 1;
+            parent[v] = u;
+            queue[(*tail)++] = v;
+            degrees += csr_get_degree(graph, v);
+
+            if (other_dist[v] >= 0 && (*best < 0 || dist[v] + other_dist[v] < *best)) {
+                *best = dist[v] + other_dist[v];
+                *meet = v;
+            }
+        }
+    }
+
+    return degrees;
+}
+
+/*
+ * BFS bidirecțional: extinde alternativ, câte un nivel, frontiera mai ieftină
+ * (înainte pe graph, înapoi pe t_graph = csr_transpose(graph)) și se oprește
+ * când cele două se întâlnesc. Întoarce aceeași distanță ca shortest_path_BFS
+ * (-1 dacă target nu e accesibil). Dacă path != NULL (graph->nodes elemente),
+ * primește drumul start ... target, iar *path_len numărul de noduri din el.
+ */
+int csr_bidirectional_shortest_path(csr_graph_t *graph, csr_graph_t *t_graph, int start, int target,
+                                    int *path, int *path_len) {
+    if (!graph || !t_graph || start < 0 || target < 0 ||
+        start >= graph->nodes || target >= graph->nodes)
+        return -1;
+
+    int n = graph->nodes;
+    int *dist_f = malloc(n * sizeof(int));
+    int *dist_b = malloc(n * sizeof(int));
+    int *parent_f = malloc(n * sizeof(int));
+    int *parent_b = malloc(n * sizeof(int));
+    int *queue_f = malloc(n * sizeof(int));
+    int *queue_b = malloc(n * sizeof(int));
+    DIE(!dist_f || !dist_b || !parent_f || !parent_b || !queue_f || !queue_b,
+        "malloc bidirectional bfs buffers failed");
+    memset(dist_f, -1, n * sizeof(int));
+    memset(dist_b, -1, n * sizeof(int));
+
+    int head_f = 0, tail_f = 0, head_b = 0, tail_b = 0;
+    int best = -1, meet = start;
+    unsigned long cost_f = csr_get_degree(graph, start);
+    unsigned long cost_b = csr_get_degree(t_graph, target);
+
+    dist_f[start] = 0;
+    parent_f[start] = -1;
+    queue_f[tail_f++] = start;
+    dist_b[target] = 0;
+    parent_b[target] = -1;
+    queue_b[tail_b++] = target;
+    if (start == target)
+        best = 0;
+
+    // orice drum mai scurt decât best ar fi fost deja găsit, vezi bidir_expand
+    while (best < 0 && head_f < tail_f && head_b < tail_b) {
+        if (cost_f <= cost_b)
+            cost_f = bidir_expand(graph, queue_f, &head_f, &tail_f, dist_f, parent_f, dist_b,
+                                  &best, &meet);
+        else
+            cost_b = bidir_expand(t_graph, queue_b, &head_b, &tail_b, dist_b, parent_b, dist_f,
+                                  &best, &meet);
+    }
+
+    if (best >= 0 && path) {
+        int len = 0;
+
+        for (int v = meet; v >= 0; v = parent_f[v])
+            path[len++] = v;
+        for (int i = 0, j = len - 1; i < j; i++, j--) {
+            int tmp = path[i];
+            path[i] = path[j];
+            path[j] = tmp;
+        }
+        for (int v = parent_b[meet]; v >= 0; v = parent_b[v])
+            path[len++] = v;
+
+        if (path_len)
+            *path_len = len;
+    } else if (path_len) {
+        *path_len = 0;
+    }
+
+    free(queue_b);
+    free(queue_f);
+    free(parent_b);
+    free(parent_f);
+    free(dist_b);
+    free(dist_f);
+    return best;
+}
+
+typedef struct {
+    csr_graph_t *graph;
+    int *parent;
+    int begin;
+    int end;
+} par_cc_arg_t;
+
+static void *par_cc_worker(void *arg) {
+    par_cc_arg_t *a = arg;
+
+    for (int u = a->begin; u < a->end; u++)
+        for (unsigned int e = a->graph->offsets[u]; e != a->graph->offsets[u + 1]; e++)
+            uf_union(a->parent, u, a->graph->adj[e]);
+
+    return NULL;
+}
+
+/*
+ * Ca lg_connected_components, dar pe CSR și cu union-find lock-free pe mai
+ * multe thread-uri: fiecare thread unește muchiile unei felii de noduri
+ * (felii cu număr aproape egal de muchii). Etichetele nu depind de threads.
+ */
+int csr_connected_components(csr_graph_t *graph, int threads, int *component) {
+    int n = graph->nodes;
+    int *parent = malloc((n ? n : 1) * sizeof(int));
+    DIE(!parent, "malloc parent failed");
+
+    if (threads < 1)
+        threads = 1;
+    for (int i = 0; i < n; i++)
+        parent[i] = i;
+
+    par_cc_arg_t *args = malloc(threads * sizeof(*args));
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    DIE(!args || !tids, "malloc threads failed");
+
+    // granițele feliilor după offsets, ca nodurile grele să nu încarce un singur thread
+    int u = 0;
+    for (int t = 0; t < threads; t++) {
+        unsigned long target = (unsigned long)graph->edges * (t + 1) / threads;
+
+        args[t].graph = graph;
+        args[t].parent = parent;
+        args[t].begin = u;
+        while (u < n && (t == threads - 1 || graph->offsets[u + 1] <= target))
+            u++;
+        args[t].end = u;
+    }
+
+    for (int t = 1; t < threads; t++)
+        DIE(pthread_create(tids + t, NULL, par_cc_worker, args + t), "pthread_create");
+    par_cc_worker(args);
+    for (int t = 1; t < threads; t++)
+        pthread_join(tids[t], NULL);
+
+    int count = uf_label(parent, n, component);
+
+    free(tids);
+    free(args);
+    free(parent);
+    return count;
+}
+
+/*
+ * Sortare topologică Kahn pe tot graful, fără recursivitate și fără
+ * visited/stack de la apelant. order (graph->nodes elemente) primește nodurile
+ * pe "valuri": valul k e order[level_start[k]] ... order[level_start[k + 1] - 1]
+ * și nodurile dintr-un val nu depind unele de altele, deci pot rula în paralel
+ * (level_start e opțional, graph->nodes + 1 elemente). Întoarce numărul de
+ * valuri sau -1 dacă graful are un ciclu; atunci order conține doar nodurile
+ * care nu depind de niciun ciclu, iar restul lipsesc.
+ */
+int topological_sort_kahn(list_graph_t *graph, int *order, int *level_start) {
+    if (!graph || !graph->neighbors || !order)
+        return -1;
+
+    int n = graph->nodes;
+    int *in_degree = calloc(n ? n : 1, sizeof(int));
+    DIE(!in_degree, "calloc in_degree failed");
+
+    for (int u = 0; u < n; u++)
+        for (ll_node_t *crt = graph->neighbors[u]->head; crt; crt = crt->next)
+            in_degree[*(int *)crt->data]++;
+
+    int tail = 0;
+    for (int u = 0; u < n; u++)
+        if (!in_degree[u])
+            order[tail++] = u;
+
+    // order e și coada: valul curent e [begin, end), următorul se scrie după el
+    int begin = 0, levels = 0;
+    while (begin < tail) {
+        int end = tail;
+
+        if (level_start)
+            level_start[levels] = begin;
+        levels++;
+
+        for (; begin < end; begin++) {
+            int u = order[begin];
+            LG_STAT_ADD(nodes_dequeued, 1);
+            for (ll_node_t *crt = graph->neighbors[u]->head; crt; crt = crt->next) {
+                int v = *(int *)crt->data;
+                LG_STAT_ADD(edges_scanned, 1);
+                if (!--in_degree[v])
+                    order[tail++] = v;
+            }
+        }
+    }
+    if (level_start)
+        level_start[levels] = tail;
+
+    free(in_degree);
+    return tail == n ? levels : -1;
+}
+
+// graful condensat are cel mult atâtea componente ca să țină închiderea în biți
+#define REACH_CLOSURE_MAX 8192
+
+/*
+ * Index de accesibilitate pentru un graf static. Componentele tare conexe
+ * (find_strongly_connected_components, în ordine topologică) devin noduri
+ * într-un DAG, pe care facem un DFS:
+ *  - [start[c], post[c]] e intervalul subarborelui DFS al lui c, deci
+ *    start[c] <= post[d] <= post[c] înseamnă sigur "c ajunge la d";
+ *  - min_post[c] e cel mai mic post al unui urmaș din DAG, deci
+ *    post[d] < min_post[c] sau post[d] > post[c] înseamnă sigur "nu".
+ * Dacă nu sunt multe componente se ține și închiderea tranzitivă în biți.
+ * Când nici intervalele nu decid, un DFS de rezervă folosește un
+ * reach_scratch_t: reach_index_query pe cel din index (deci nu se cheamă din
+ * mai multe thread-uri deodată), reach_index_query_r pe unul dat de apelant,
+ * câte unul per thread.
+ */
+typedef struct {
+    unsigned int *stamp;
+    unsigned int epoch;
+    int *stack;
+} reach_scratch_t;
+
+typedef struct {
+    int nodes;
+    int comps;
+    int *comp;
+    csr_graph_t *dag;
+    int *start;
+    int *post;
+    int *min_post;
+    unsigned long *closure;     // comps * BITMAP_WORDS(comps) sau NULL
+    reach_scratch_t scratch;    // folosit de reach_index_query
+} reach_index_t;
+
+static csr_graph_t *condense_graph(list_graph_t *graph, const int *comp, int comps) {
+    unsigned int edges = 0;
+    for (int u = 0; u < graph->nodes; u++)
+        edges += graph->neighbors[u]->size;
+
+    int *pairs = malloc((2 * (size_t)edges + 2) * sizeof(int));
+    DIE(!pairs, "malloc pairs failed");
+
+    unsigned int count = 0;
+    for (int u = 0; u < graph->nodes; u++) {
+        for (ll_node_t *crt = graph->neighbors[u]->head; crt; crt = crt->next) {
+            int v = *(int *)crt->data;
+            if (comp[u] != comp[v]) {
+                pairs[2 * count] = comp[u];
+                pairs[2 * count + 1] = comp[v];
+                count++;
+            }
+        }
+    }
+
+    csr_graph_t *dag = csr_from_edges(comps, pairs, count, 1);
+    free(pairs);
+
+    // scoatem muchiile duplicate, pe loc
+    int *seen = malloc((comps ? comps : 1) * sizeof(int));
+    DIE(!seen, "malloc seen failed");
+    for (int c = 0; c < comps; c++)
+        seen[c] = -1;
+
+    unsigned int pos = 0;
+    for (int c = 0; c < comps; c++) {
+        unsigned int begin = dag->offsets[c], end = dag->offsets[c + 1];
+        dag->offsets[c] = pos;
+        for (unsigned int e = begin; e < end; e++) {
+            int d = dag->adj[e];
+            if (seen[d] != c) {
+                seen[d] = c;
+                dag->adj[pos++] = d;
+            }
+        }
+    }
+    dag->offsets[comps] = pos;
+    dag->edges = pos;
+
+    free(seen);
+    return dag;
+}
+
+static void reach_scratch_init(reach_scratch_t *s, const reach_index_t *idx) {
+    s->stamp = calloc(idx->comps ? idx->comps : 1, sizeof(unsigned int));
+    s->stack = malloc((idx->dag->edges + 1) * sizeof(int));
+    DIE(!s->stamp || !s->stack, "malloc reach scratch failed");
+    s->epoch = 0;
+}
+
+reach_index_t *reach_index_build(list_graph_t *graph) {
+    if (!graph || !graph->neighbors)
+        return NULL;
+
+    int n = graph->nodes;
+    reach_index_t *idx = calloc(1, sizeof(*idx));
+    DIE(!idx, "calloc reach index failed");
+
+    idx->nodes = n;
+    idx->comp = malloc((n ? n : 1) * sizeof(int));
+    DIE(!idx->comp, "malloc comp failed");
+    find_strongly_connected_components(graph, idx->comp, &idx->comps);
+
+    int c_count = idx->comps;
+    idx->dag = condense_graph(graph, idx->comp, c_count);
+    idx->start = malloc((c_count ? c_count : 1) * sizeof(int));
+    idx->post = malloc((c_count ? c_count : 1) * sizeof(int));
+    idx->min_post = malloc((c_count ? c_count : 1) * sizeof(int));
+    reach_scratch_init(&idx->scratch, idx);
+    unsigned int *cursor = malloc((c_count ? c_count : 1) * sizeof(unsigned int));
+    int *frames = malloc((c_count ? c_count : 1) * sizeof(int));
+    DIE(!idx->start || !idx->post || !idx->min_post || !cursor || !frames,
+        "malloc reach index buffers failed");
+
+    csr_graph_t *dag = idx->dag;
+    unsigned int *seen = idx->scratch.stamp;
+    int finished = 0;
+
+    for (int c = 0; c < c_count; c++)
+        idx->post[c] = -1;
+
+    // DFS iterativ pe DAG; o componentă se termină după toți urmașii ei
+    for (int root = 0; root < c_count; root++) {
+        int depth = 0;
+
+        if (idx->post[root] >= 0 || seen[root])
+            continue;
+
+        seen[root] = 1;
+        idx->start[root] = finished;
+        cursor[root] = dag->offsets[root];
+        frames[depth++] = root;
+
+        while (depth) {
+            int c = frames[depth - 1];
+
+            if (cursor[c] != dag->offsets[c + 1]) {
+                int d = dag->adj[cursor[c]++];
+                if (!seen[d]) {
+                    seen[d] = 1;
+                    idx->start[d] = finished;
+                    cursor[d] = dag->offsets[d];
+                    frames[depth++] = d;
+                }
+                continue;
+            }
+
+            idx->post[c] = finished++;
+            idx->min_post[c] = idx->start[c];
+            for (unsigned int e = dag->offsets[c]; e != dag->offsets[c + 1]; e++)
+                if (idx->min_post[dag->adj[e]] < idx->min_post[c])
+                    idx->min_post[c] = idx->min_post[dag->adj[e]];
+            depth--;
+        }
+    }
+
+    memset(seen, 0, (c_count ? c_count : 1) * sizeof(unsigned int));
+    free(frames);
+    free(cursor);
+
+    if (c_count <= REACH_CLOSURE_MAX) {
+        size_t words = BITMAP_WORDS(c_count);
+        idx->closure = calloc(c_count * words + 1, sizeof(unsigned long));
+        DIE(!idx->closure, "calloc closure failed");
+
+        // în ordine topologică inversă, copiii sunt deja gata
+        for (int c = c_count - 1; c >= 0; c--) {
+            unsigned long *row = idx->closure + c * words;
+            bitmap_set(row, c);
+            for (unsigned int e = dag->offsets[c]; e != dag->offsets[c + 1]; e++) {
+                unsigned long *child = idx->closure + dag->adj[e] * words;
+                for (size_t w = 0; w < words; w++)
+                    row[w] |= child[w];
+            }
+        }
+    }
+
+    return idx;
+}
+
+// memorie de lucru pentru reach_index_query_r, valabilă pentru idx
+reach_scratch_t *reach_scratch_create(const reach_index_t *idx) {
+    if (!idx)
+        return NULL;
+
+    reach_scratch_t *s = malloc(sizeof(*s));
+    DIE(!s, "malloc reach scratch failed");
+    reach_scratch_init(s, idx);
+    return s;
+}
+
+void reach_scratch_free(reach_scratch_t *s) {
+    if (!s)
+        return;
+
+    free(s->stamp);
+    free(s->stack);
+    free(s);
+}
+
+/*
+ * 1 dacă există drum src -> dest, ca path_exists. idx nu e modificat, deci
+ * mai multe thread-uri pot întreba același index, fiecare cu scratch-ul lui.
+ */
+int reach_index_query_r(const reach_index_t *idx, reach_scratch_t *s, int src, int dest) {
+    if (!idx || !s || src < 0 || src >= idx->nodes || dest < 0 || dest >= idx->nodes)
+        return 0;
+
+    int cs = idx->comp[src], cd = idx->comp[dest];
+    if (cs == cd)
+        return 1;
+    if (cs > cd)    // numerotarea e topologică
+        return 0;
+    if (idx->closure)
+        return bitmap_test(idx->closure + cs * BITMAP_WORDS(idx->comps), cd);
+
+    int pd = idx->post[cd];
+    if (idx->start[cs] <= pd && pd <= idx->post[cs])
+        return 1;
+    if (pd < idx->min_post[cs] || pd > idx->post[cs])
+        return 0;
+
+    // rezervă: DFS pe DAG, doar prin componentele care încă pot ajunge la cd
+    if (++s->epoch == 0) {
+        memset(s->stamp, 0, idx->comps * sizeof(unsigned int));
+        s->epoch = 1;
+    }
+
+    int top = 0;
+    csr_graph_t *dag = idx->dag;
+    s->stamp[cs] = s->epoch;
+    s->stack[top++] = cs;
+    while (top) {
+        int c = s->stack[--top];
+
+        if (idx->start[c] <= pd && pd <= idx->post[c])
+            return 1;
+
+        for (unsigned int e = dag->offsets[c]; e != dag->offsets[c + 1]; e++) {
+            int d = dag->adj[e];
+            if (s->stamp[d] == s->epoch || d > cd ||
+                pd < idx->min_post[d] || pd > idx->post[d])
+                continue;
+            s->stamp[d] = s->epoch;
+            s->stack[top++] = d;
+        }
+    }
+
+    return 0;
+}
+
+// ca reach_index_query_r, cu scratch-ul indexului: nu e sigur între thread-uri
+int reach_index_query(reach_index_t *idx, int src, int dest) {
+    if (!idx)
+        return 0;
+
+    return reach_index_query_r(idx, &idx->scratch, src, dest);
+}
+
+void reach_index_free(reach_index_t *idx) {
+    if (!idx)
+        return;
+
+    free(idx->closure);
+    free(idx->scratch.stack);
+    free(idx->scratch.stamp);
+    free(idx->min_post);
+    free(idx->post);
+    free(idx->start);
+    csr_free(idx->dag);
+    free(idx->comp);
+    free(idx);
+}
+
+/*
+ * Componente tare conexe întreținute la adăugări / ștergeri de muchii făcute
+ * prin dyn_scc_add_edge / dyn_scc_remove_edge. Componentele au id-uri stabile
+ * în [0, nodes) (nu neapărat consecutive) și sunt ținute într-o ordine
+ * topologică: at[p] e componenta de pe poziția p (-1 = gol), ord[c] poziția ei.
+ *  - adăugare u -> v cu ord[cu] < ord[cv]: nu se schimbă nimic;
+ *  - altfel (Marchetti-Spaccamela et al.) căutăm înainte din v doar prin
+ *    componentele cu poziția <= ord[cu] și reordonăm doar acel interval;
+ *    dacă ajungem la u s-a format un ciclu și unim componentele de pe el;
+ *  - ștergere u -> v în aceeași componentă: Tarjan doar pe nodurile ei.
+ */
+typedef struct {
+    list_graph_t *graph;
+    int nodes;
+    int num_components;
+    int *comp;
+    int *ord;
+    int *at;            // 2 * nodes poziții, compactate când se umplu
+    int slots;
+    int *head;          // membrii componentei c: head[c], next[head[c]], ...
+    int *next;
+    int *size;
+    int *free_ids;
+    int n_free;
+    unsigned int *stamp;    // per componentă: atinsă în căutarea curentă
+    unsigned int *reach;    // per componentă: ajunge la cu
+    unsigned int epoch;
+    int *stack;
+    int *scratch;
+    int *sub;
+    scc_work_t work;
+} dyn_scc_t;
+
+static void dyn_scc_next_epoch(dyn_scc_t *d) {
+    if (++d->epoch == 0) {
+        memset(d->stamp, 0, d->nodes * sizeof(unsigned int));
+        memset(d->reach, 0, d->nodes * sizeof(unsigned int));
+        d->epoch = 1;
+    }
+}
+
+static void dyn_scc_compact(dyn_scc_t *d) {
+    int k = 0;
+    for (int p = 0; p < d->slots; p++) {
+        if (d->at[p] >= 0) {
+            d->at[k] = d->at[p];
+            d->ord[d->at[k]] = k;
+            k++;
+        }
+    }
+    d->slots = k;
+}
+
+dyn_scc_t *dyn_scc_create(list_graph_t *graph) {
+    if (!graph || !graph->neighbors)
+        return NULL;
+
+    int n = graph->nodes, m = n ? n : 1;
+    dyn_scc_t *d = calloc(1, sizeof(*d));
+    DIE(!d, "calloc dyn scc failed");
+
+    d->graph = graph;
+    d->nodes = n;
+    d->comp = malloc(m * sizeof(int));
+    d->ord = malloc(m * sizeof(int));
+    d->at = malloc(2 * m * sizeof(int));
+    d->head = malloc(m * sizeof(int));
+    d->next = malloc(m * sizeof(int));
+    d->size = calloc(m, sizeof(int));
+    d->free_ids = malloc(m * sizeof(int));
+    d->stamp = calloc(m, sizeof(unsigned int));
+    d->reach = calloc(m, sizeof(unsigned int));
+    d->stack = malloc(m * sizeof(int));
+    d->scratch = malloc(2 * m * sizeof(int));
+    d->sub = malloc(m * sizeof(int));
+    DIE(!d->comp || !d->ord || !d->at || !d->head || !d->next || !d->size || !d->free_ids ||
+        !d->stamp || !d->reach || !d->stack || !d->scratch || !d->sub, "malloc dyn scc failed");
+    scc_work_init(&d->work, m);
+
+    // pornim de la componentele calculate o dată, deja în ordine topologică
+    find_strongly_connected_components(graph, d->comp, &d->num_components);
+    for (int c = 0; c < n; c++)
+        d->head[c] = -1;
+    for (int v = n - 1; v >= 0; v--) {
+        int c = d->comp[v];
+        d->next[v] = d->head[c];
+        d->head[c] = v;
+        d->size[c]++;
+    }
+    for (int c = 0; c < d->num_components; c++)
+        d->ord[c] = d->at[c] = c;
+    d->slots = d->num_components;
+    for (int c = n - 1; c >= d->num_components; c--)
+        d->free_ids[d->n_free++] = c;
+
+    return d;
+}
+
+static void dyn_scc_push_members(dyn_scc_t *d, int c, int *top) {
+    for (int x = d->head[c]; x >= 0; x = d->next[x])
+        d->stack[(*top)++] = x;
+}
+
+// mută membrii lui from în into
+static void dyn_scc_merge(dyn_scc_t *d, int into, int from) {
+    int x = d->head[from], last = -1;
+
+    for (; x >= 0; x = d->next[x]) {
+        d->comp[x] = into;
+        last = x;
+    }
+    d->next[last] = d->head[into];
+    d->head[into] = d->head[from];
+    d->size[into] += d->size[from];
+    d->head[from] = -1;
+    d->size[from] = 0;
+    d->free_ids[d->n_free++] = from;
+    d->num_components--;
+}
+
+void dyn_scc_add_edge(dyn_scc_t *d, int u, int v) {
+    if (!d || u < 0 || v < 0 || u >= d->nodes || v >= d->nodes)
+        return;
+
+    lg_add_edge(d->graph, u, v);
+
+    int cu = d->comp[u], cv = d->comp[v];
+    if (cu == cv || d->ord[cu] < d->ord[cv])
+        return;
+
+    int lb = d->ord[cv], ub = d->ord[cu], top = 0;
+
+    // 1. tot ce se poate atinge din v fără să trecem de poziția lui cu
+    dyn_scc_next_epoch(d);
+    d->stamp[cv] = d->epoch;
+    dyn_scc_push_members(d, cv, &top);
+    while (top) {
+        int x = d->stack[--top];
+        for (ll_node_t *crt = d->graph->neighbors[x]->head; crt; crt = crt->next) {
+            int cy = d->comp[*(int *)crt->data];
+            if (d->stamp[cy] == d->epoch || d->ord[cy] > ub)
+                continue;
+            d->stamp[cy] = d->epoch;
+            dyn_scc_push_members(d, cy, &top);
+        }
+    }
+
+    // 2. dacă am ajuns la cu, tot ce e atins și ajunge la cu e pe un ciclu
+    int merged = -1;
+    if (d->stamp[cu] == d->epoch) {
+        d->reach[cu] = d->epoch;
+        for (int p = ub - 1; p >= lb; p--) {
+            int c = d->at[p];
+            if (c < 0 || d->stamp[c] != d->epoch)
+                continue;
+            for (int x = d->head[c]; x >= 0 && d->reach[c] != d->epoch; x = d->next[x])
+                for (ll_node_t *crt = d->graph->neighbors[x]->head; crt; crt = crt->next)
+                    if (d->reach[d->comp[*(int *)crt->data]] == d->epoch) {
+                        d->reach[c] = d->epoch;
+                        break;
+                    }
+        }
+
+        merged = cu;
+        for (int p = lb; p <= ub; p++) {
+            int c = d->at[p];
+            if (c >= 0 && d->reach[c] == d->epoch && d->size[c] > d->size[merged])
+                merged = c;
+        }
+        for (int p = lb; p <= ub; p++) {
+            int c = d->at[p];
+            if (c >= 0 && c != merged && d->reach[c] == d->epoch) {
+                dyn_scc_merge(d, merged, c);
+                d->at[p] = -1;
+            }
+        }
+    }
+
+    // 3. în interval: întâi ce nu e atins, apoi ciclul unit, apoi restul atinse
+    int k = 0;
+    for (int p = lb; p <= ub; p++) {
+        int c = d->at[p];
+        if (c >= 0 && c != merged && d->stamp[c] != d->epoch)
+            d->scratch[k++] = c;
+    }
+    if (merged >= 0)
+        d->scratch[k++] = merged;
+    for (int p = lb; p <= ub; p++) {
+        int c = d->at[p];
+        if (c >= 0 && c != merged && d->stamp[c] == d->epoch)
+            d->scratch[k++] = c;
+    }
+    for (int p = lb; p <= ub; p++) {
+        d->at[p] = p - lb < k ? d->scratch[p - lb] : -1;
+        if (d->at[p] >= 0)
+            d->ord[d->at[p]] = p;
+    }
+}
+
+void dyn_scc_remove_edge(dyn_scc_t *d, int u, int v) {
+    if (!d || u < 0 || v < 0 || u >= d->nodes || v >= d->nodes)
+        return;
+
+    // o muchie care nu există nu poate rupe componenta
+    if (!lg_remove_edge(d->graph, u, v))
+        return;
+
+    int c = d->comp[u];
+    if (c != d->comp[v] || d->size[c] == 1)
+        return;
+
+    // Tarjan doar pe membrii lui c; restul grafului nu e atins
+    int k = 0;
+    for (int x = d->head[c]; x >= 0; x = d->next[x])
+        d->work.index[x] = -1;
+    d->work.counter = 0;
+    d->work.top = 0;
+    for (int x = d->head[c]; x >= 0; x = d->next[x])
+        if (d->work.index[x] < 0)
+            tarjan_visit(d->graph, x, d->comp, c, &d->work, d->sub, &k);
+
+    if (k == 1)
+        return;
+
+    // sub-componenta k - 1 e prima în ordinea topologică și păstrează id-ul c
+    int *ids = d->scratch;
+    for (int j = 0; j < k - 1; j++) {
+        ids[j] = d->free_ids[--d->n_free];
+        d->head[ids[j]] = -1;
+        d->size[ids[j]] = 0;
+    }
+    ids[k - 1] = c;
+
+    int x = d->head[c];
+    d->head[c] = -1;
+    d->size[c] = 0;
+    while (x >= 0) {
+        int nx = d->next[x], id = ids[d->sub[x]];
+        d->comp[x] = id;
+        d->next[x] = d->head[id];
+        d->head[id] = x;
+        d->size[id]++;
+        x = nx;
+    }
+    d->num_components += k - 1;
+
+    // k - 1 poziții noi imediat după c
+    if (d->slots + k - 1 > 2 * d->nodes)
+        dyn_scc_compact(d);
+    int p = d->ord[c];
+    memmove(d->at + p + k, d->at + p + 1, (d->slots - p - 1) * sizeof(int));
+    d->slots += k - 1;
+    for (int q = p + k; q < d->slots; q++)
+        if (d->at[q] >= 0)
+            d->ord[d->at[q]] = q;
+    for (int j = 0; j < k; j++) {
+        d->at[p + j] = ids[k - 1 - j];
+        d->ord[ids[k - 1 - j]] = p + j;
+    }
+}
+
+int dyn_scc_component(dyn_scc_t *d, int node) {
+    if (!d || node < 0 || node >= d->nodes)
+        return -1;
+    return d->comp[node];
 }
 
-void
-lg_remove_edge(list_graph_t* graph, int src, int dest)
-{
-	unsigned int pos;
+// 1 dacă a ajunge la b; se caută doar printre componentele dintre ele
+int dyn_scc_reaches(dyn_scc_t *d, int a, int b) {
+    if (!d || a < 0 || b < 0 || a >= d->nodes || b >= d->nodes)
+        return 0;
 
-	if (
-		!graph || !graph->neighbors
-		|| !is_node_in_graph(src, graph->nodes)
-		|| !is_node_in_graph(dest, graph->nodes)
-	)
-		return;
+    int ca = d->comp[a], cb = d->comp[b], top = 0;
+    if (ca == cb)
+        return 1;
+    if (d->ord[ca] > d->ord[cb])
+        return 0;
 
-	if (!find_node(graph->neighbors[src], dest, &pos))
-		return;
+    dyn_scc_next_epoch(d);
+    d->stamp[ca] = d->epoch;
+    dyn_scc_push_members(d, ca, &top);
+    while (top) {
+        int x = d->stack[--top];
+        for (ll_node_t *crt = d->graph->neighbors[x]->head; crt; crt = crt->next) {
+            int cy = d->comp[*(int *)crt->data];
+            if (cy == cb)
+                return 1;
+            if (d->stamp[cy] == d->epoch || d->ord[cy] > d->ord[cb])
+                continue;
+            d->stamp[cy] = d->epoch;
+            dyn_scc_push_members(d, cy, &top);
+        }
+    }
 
-	ll_remove_nth_node(graph->neighbors[src], pos);
+    return 0;
 }
 
-void
-lg_free(list_graph_t* graph)
-{
-	int i;
+/*
+ * Aceleași ieșiri ca find_strongly_connected_components: id-uri 0, 1, ...
+ * în ordine topologică. Întoarce numărul de componente.
+ */
+int dyn_scc_labels(dyn_scc_t *d, int *component) {
+    int *dense = d->scratch, count = 0;
 
-	for (i = 0; i != graph->nodes; ++i)
-		ll_free(graph->neighbors + i);
-	
-	free(graph->neighbors);
-	free(graph);
+    for (int p = 0; p < d->slots; p++)
+        if (d->at[p] >= 0)
+            dense[d->at[p]] = count++;
+    for (int v = 0; v < d->nodes; v++)
+        component[v] = dense[d->comp[v]];
+
+    return count;
 }
 
+void dyn_scc_free(dyn_scc_t *d) {
+    if (!d)
+        return;
 
+    scc_work_free(&d->work);
+    free(d->sub);
+    free(d->scratch);
+    free(d->stack);
+    free(d->reach);
+    free(d->stamp);
+    free(d->free_ids);
+    free(d->size);
+    free(d->next);
+    free(d->head);
+    free(d->at);
+    free(d->ord);
+    free(d->comp);
+    free(d);
+}
 
-// ------------------- CHEAT SHEET START HERE -------------------
+// strategii pentru lg_compute_order
+#define LG_ORDER_DEGREE 0   // grad descrescător: nodurile grele la început, împreună
+#define LG_ORDER_RCM 1      // Reverse Cuthill-McKee: vecinii primesc id-uri apropiate
 
-void BFS(list_graph_t* graph, int start_node, int *color) {
-    queue_t *q;
-    int *node;
+static int cmp_long_long(const void *a, const void *b) {
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return x < y ? -1 : x > y;
+}
 
-    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
+/*
+ * Calculează o renumerotare a nodurilor: perm[vechi] = nou, inv[nou] = vechi.
+ * Graful renumerotat se obține cu lg_permute / csr_permute; un rezultat
+ * calculat pe el (de ex. dist) se citește pentru nodul original v la
+ * dist[perm[v]].
+ */
+void lg_compute_order(list_graph_t *graph, int strategy, int *perm, int *inv) {
+    int n = graph->nodes, max_degree = 0;
+    int *by_degree = malloc((n ? n : 1) * sizeof(int));
+    int *count;
+    DIE(!by_degree, "malloc order buffers failed");
+
+    // counting sort după grad, descrescător, stabil după id
+    for (int u = 0; u < n; u++)
+        if ((int)graph->neighbors[u]->size > max_degree)
+            max_degree = graph->neighbors[u]->size;
+    count = calloc(max_degree + 2, sizeof(int));
+    DIE(!count, "calloc count failed");
+    for (int u = 0; u < n; u++)
+        count[max_degree - graph->neighbors[u]->size + 1]++;
+    for (int d = 1; d <= max_degree + 1; d++)
+        count[d] += count[d - 1];
+    for (int u = 0; u < n; u++)
+        by_degree[count[max_degree - graph->neighbors[u]->size]++] = u;
+    free(count);
+
+    if (strategy != LG_ORDER_RCM) {
+        for (int i = 0; i < n; i++) {
+            inv[i] = by_degree[i];
+            perm[by_degree[i]] = i;
+        }
+        free(by_degree);
         return;
+    }
+
+    // Cuthill-McKee: BFS din nodul de grad minim, vecinii în ordinea gradului;
+    // `inv` e și coada, `perm` ține minte cine a fost vizitat
+    long long *keys = malloc((max_degree ? max_degree : 1) * sizeof(long long));
+    DIE(!keys, "malloc keys failed");
+    for (int u = 0; u < n; u++)
+        perm[u] = -1;
+
+    int head = 0, tail = 0;
+    for (int i = n - 1; i >= 0; i--) {
+        int root = by_degree[i];
+        if (perm[root] >= 0)
+            continue;
+
+        perm[root] = tail;
+        inv[tail++] = root;
+        while (head < tail) {
+            int u = inv[head++], k = 0;
+
+            for (ll_node_t *crt = graph->neighbors[u]->head; crt; crt = crt->next) {
+                int v = *(int *)crt->data;
+                if (perm[v] < 0) {
+                    perm[v] = 0;    // rezervat, primește poziția mai jos
+                    keys[k++] = (long long)graph->neighbors[v]->size << 32 | v;
+                }
+            }
+            qsort(keys, k, sizeof(*keys), cmp_long_long);
+            for (int j = 0; j < k; j++) {
+                int v = (int)(keys[j] & 0xffffffff);
+                perm[v] = tail;
+                inv[tail++] = v;
+            }
+        }
+    }
+
+    // reverse
+    for (int i = 0; i < n; i++) {
+        int v = inv[n - 1 - i];
+        perm[v] = i;
+    }
+    for (int u = 0; u < n; u++)
+        inv[perm[u]] = u;
 
-    q = q_create(sizeof(int), graph->nodes);
-    q_enqueue(q, &start_node);
+    free(keys);
+    free(by_degree);
+}
 
-    while (!q_is_empty(q)) {
-        node = (int *)q_front(q);
-        q_dequeue(q);
+// Graf nou cu nodul u redenumit perm[u]; ordinea vecinilor se păstrează.
+list_graph_t *lg_permute(list_graph_t *graph, const int *perm) {
+    int n = graph->nodes;
+    unsigned int edges = 0, k = 0;
+
+    for (int u = 0; u < n; u++)
+        edges += graph->neighbors[u]->size;
+
+    int *pairs = malloc((2 * (size_t)edges + 2) * sizeof(int));
+    int *weights = graph->weighted ? malloc((edges + 1) * sizeof(int)) : NULL;
+    DIE(!pairs || (graph->weighted && !weights), "malloc pairs failed");
+    for (int u = 0; u < n; u++) {
+        for (ll_node_t *crt = graph->neighbors[u]->head; crt; crt = crt->next) {
+            pairs[2 * k] = perm[u];
+            pairs[2 * k + 1] = perm[*(int *)crt->data];
+            if (weights)
+                weights[k] = ((lg_wedge_t *)crt->data)->weight;
+            k++;
+        }
+    }
 
-        color[*node] = 1;  // Mark the node as visited
+    list_graph_t *p_graph = graph->weighted ? lg_create_weighted(n)
+                          : graph->arena ? lg_create_slab(n) : lg_create(n);
+    lg_add_weighted_edges(p_graph, pairs, weights, k);
 
-        linked_list_t *neighbours = lg_get_neighbours(graph, *node);
-        ll_node_t *crt = neighbours->head;
+    free(weights);
+    free(pairs);
+    return p_graph;
+}
 
-        while (crt) {
-            if (!color[*(int *)crt->data]) {
-                q_enqueue(q, crt->data);
+// La fel pe CSR; vecinii fiecărui nod ies sortați, ca să fie citiți în ordine.
+csr_graph_t *csr_permute(csr_graph_t *graph, const int *perm) {
+    int n = graph->nodes;
+    int *inv = malloc((n ? n : 1) * sizeof(int));
+    DIE(!inv, "malloc inv failed");
+    for (int u = 0; u < n; u++)
+        inv[perm[u]] = u;
+
+    csr_graph_t *p_graph = csr_create(n, graph->edges);
+    // la grafurile cu costuri sortăm perechi (dest, cost); cmp_int compară dest
+    lg_wedge_t *row = NULL;
+    if (graph->weights) {
+        p_graph->weights = malloc((graph->edges ? graph->edges : 1) * sizeof(int));
+        row = malloc((graph->edges ? graph->edges : 1) * sizeof(*row));
+        DIE(!p_graph->weights || !row, "malloc weights failed");
+    }
+
+    unsigned int pos = 0;
+    for (int i = 0; i < n; i++) {
+        int u = inv[i];
+
+        p_graph->offsets[i] = pos;
+        if (row) {
+            unsigned int deg = 0;
+            for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++, deg++) {
+                row[deg].dest = perm[graph->adj[e]];
+                row[deg].weight = graph->weights[e];
             }
-            crt = crt->next;
+            qsort(row, deg, sizeof(*row), cmp_int);
+            for (unsigned int k = 0; k < deg; k++, pos++) {
+                p_graph->adj[pos] = row[k].dest;
+                p_graph->weights[pos] = row[k].weight;
+            }
+            continue;
         }
+        for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++)
+            p_graph->adj[pos++] = perm[graph->adj[e]];
+        qsort(p_graph->adj + p_graph->offsets[i], pos - p_graph->offsets[i], sizeof(int), cmp_int);
     }
+    p_graph->offsets[n] = pos;
 
-    q_free(q);
+    free(row);
+    free(inv);
+    return p_graph;
 }
 
-void DFS(list_graph_t* graph, int start_node, int *color) {
-    stack_t *st;
-    int *node;
 
-    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
-        return;
+// ------------------- VARIANTE PE ADIACENȚA COMPRIMATĂ (csr_compress) -------------------
+// vecinii vin sortați crescător, nu în ordinea din liste
 
-    st = st_create(sizeof(int));
-    st_push(st, &start_node);
+void vcsr_BFS(vcsr_graph_t *graph, int start_node, int *color) {
+    if (!graph || start_node < 0 || start_node >= graph->nodes)
+        return;
 
-    while (!st_is_empty(st)) {
-        node = (int *)st_peek(st);
-        st_pop(st);
+    int *queue = malloc(graph->nodes * sizeof(int));
+    int *neigh = malloc((graph->max_degree + 1) * sizeof(int));
+    DIE(!queue || !neigh, "malloc bfs buffers failed");
 
-        if (color[*node] == 0) {
-            color[*node] = 1;  // Mark the node as visited
-            printf("%d ", *node);
+    int head = 0, tail = 0;
+    queue[tail++] = start_node;
+    color[start_node] = 1;
 
-            linked_list_t *neighbours = lg_get_neighbours(graph, *node);
-            ll_node_t *crt = neighbours->head;
+    while (head != tail) {
+        int node = queue[head++];
+        unsigned int deg = vcsr_get_neighbours(graph, node, neigh);
 
-            while (crt) {
-                if (color[*(int *)crt->data] == 0) {
-                    st_push(st, crt->data);
-                }
-                crt = crt->next;
+        for (unsigned int i = 0; i < deg; i++) {
+            if (!color[neigh[i]]) {
+                color[neigh[i]] = 1;
+                queue[tail++] = neigh[i];
             }
         }
     }
 
-    st_free(st);
+    free(neigh);
+    free(queue);
 }
 
-void print_k_BFS_level(list_graph_t *graph, int start_node, int k)
-{
-    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes || k < 0)
+void vcsr_DFS(vcsr_graph_t *graph, int start_node, int *color) {
+    if (!graph || start_node < 0 || start_node >= graph->nodes)
         return;
 
-    // Inițializare vector vizitat
-    int *visited = calloc(graph->nodes, sizeof(int));
-    if (!visited) return;
+    int *stack = malloc((graph->edges + 1) * sizeof(int));
+    int *neigh = malloc((graph->max_degree + 1) * sizeof(int));
+    DIE(!stack || !neigh, "malloc dfs buffers failed");
 
-    // Inițializare coadă
-    queue_t *q = q_create(sizeof(int), graph->nodes);
-    if (!q) {
-        free(visited);
-        return;
+    unsigned int top = 0;
+    stack[top++] = start_node;
+
+    while (top) {
+        int node = stack[--top];
+
+        if (color[node])
+            continue;
+
+        color[node] = 1;  // Mark the node as visited
+        printf("%d ", node);
+
+        unsigned int deg = vcsr_get_neighbours(graph, node, neigh);
+        for (unsigned int i = 0; i < deg; i++)
+            if (!color[neigh[i]])
+                stack[top++] = neigh[i];
     }
 
-    // Începem cu nodul de start
-    q_enqueue(q, &start_node);
+    free(neigh);
+    free(stack);
+}
+
+void vcsr_print_k_BFS_level(vcsr_graph_t *graph, int start_node, int k)
+{
+    if (!graph || start_node < 0 || start_node >= graph->nodes || k < 0)
+        return;
+
+    int *visited = calloc(graph->nodes, sizeof(int));
+    int *queue = malloc(graph->nodes * sizeof(int));
+    int *neigh = malloc((graph->max_degree + 1) * sizeof(int));
+    DIE(!visited || !queue || !neigh, "malloc bfs buffers failed");
+
+    int head = 0, tail = 0, level = 0;
+    queue[tail++] = start_node;
     visited[start_node] = 1;
-    int level = 0;
 
-    while (!q_is_empty(q)) {
-        int level_size = q_get_size(q);
+    while (head != tail) {
+        int level_end = tail;
 
-        for (int i = 0; i < level_size; i++) {
-            int node = *(int *)q_front(q);
-            q_dequeue(q);
+        for (; head < level_end; head++) {
+            int node = queue[head];
 
-            if (level == k)
+            if (level == k) {
                 printf("%d ", node);
+                continue;  // nu mai avem nevoie de vecini
+            }
 
-            linked_list_t *neighbours = lg_get_neighbours(graph, node);
-            if (!neighbours) continue;
-
-            ll_node_t *crt = neighbours->head;
-            while (crt) {
-                int v = *(int *)crt->data;
-                if (!visited[v]) {
-                    visited[v] = 1;
-                    q_enqueue(q, &v);
+            unsigned int deg = vcsr_get_neighbours(graph, node, neigh);
+            for (unsigned int i = 0; i < deg; i++) {
+                if (!visited[neigh[i]]) {
+                    visited[neigh[i]] = 1;
+                    queue[tail++] = neigh[i];
                 }
-                crt = crt->next;
             }
         }
 
-        // Dacă am ajuns la nivelul dorit, ne oprim
         if (level == k)
             break;
-
         level++;
     }
 
     printf("\n");
-    q_free(q);
+    free(neigh);
+    free(queue);
     free(visited);
 }
 
-void print_BFS_levels(list_graph_t* graph, int start_node)
-{
-    if (!graph || !graph->neighbors || start_node < 0 || start_node >= graph->nodes)
-        return;
+// ------------------- DRUMURI MINIME CU COSTURI (lg_create_weighted) -------------------
+
+/*
+ * heap 4-ar: cei 4 fii ai lui i sunt a[4i+1 .. 4i+4], 4 * 16 octeți. Vectorul
+ * e aliniat la 64 și mutat cu 3 intrări, ca a[1] (deci fiecare grup de fii)
+ * să înceapă pe o linie de cache și să stea într-una singură.
+ */
+#define DHEAP_LINE 64
+#define DHEAP_SKEW 3
+
+typedef struct {
+    long long key;
+    int node;
+} dheap_entry_t;
+
+typedef struct {
+    dheap_entry_t *a;
+    dheap_entry_t *mem;     // blocul alocat; a = mem + DHEAP_SKEW
+    int *pos;   // poziția nodului în heap, -1 dacă nu e în heap
+    int size;
+} dheap_t;
+
+static void dheap_init(dheap_t *h, int n) {
+    size_t bytes = (n + DHEAP_SKEW + 1) * sizeof(*h->a);
+
+    // aligned_alloc vrea o dimensiune multiplu de aliniere
+    bytes = (bytes + DHEAP_LINE - 1) & ~(size_t)(DHEAP_LINE - 1);
+    h->mem = aligned_alloc(DHEAP_LINE, bytes);
+    h->pos = malloc((n ? n : 1) * sizeof(int));
+    DIE(!h->mem || !h->pos, "malloc heap failed");
+    h->a = h->mem + DHEAP_SKEW;
+    for (int i = 0; i < n; i++)
+        h->pos[i] = -1;
+    h->size = 0;
+}
 
-    int *visited = calloc(graph->nodes, sizeof(int));
-    queue_t *q = q_create(sizeof(int), graph->nodes);
-    q_enqueue(q, &start_node);
-    visited[start_node] = 1;
+static void dheap_free(dheap_t *h) {
+    free(h->pos);
+    free(h->mem);
+}
 
-    while (!q_is_empty(q)) {
-        int level_size = q_get_size(q);
-        for (int i = 0; i < level_size; i++) {
-            int node = *(int *)q_front(q);
-            q_dequeue(q);
-            printf("%d ", node);
-            linked_list_t *neighbours = lg_get_neighbours(graph, node);
-            ll_node_t *crt = neighbours->head;
-            while (crt) {
-                int v = *(int *)crt->data;
-                if (!visited[v]) {
-                    visited[v] = 1;
-                    q_enqueue(q, &v);
-                }
-                crt = crt->next;
-            }
-        }
-        printf("\n");
-    }
+static void dheap_sift_up(dheap_t *h, int i) {
+    dheap_entry_t x = h->a[i];
 
-    q_free(q);
-    free(visited);
+    while (i > 0) {
+        int p = (i - 1) / 4;
+        if (h->a[p].key <= x.key)
+            break;
+        h->a[i] = h->a[p];
+        h->pos[h->a[i].node] = i;
+        i = p;
+    }
+    h->a[i] = x;
+    h->pos[x.node] = i;
 }
 
-int path_exists(list_graph_t* graph, int src, int dest, int *visited) {
-    if (!graph || !graph->neighbors || src < 0 || src >= graph->nodes || dest < 0 || dest >= graph->nodes)
-        return 0;
+static void dheap_sift_down(dheap_t *h, int i) {
+    dheap_entry_t x = h->a[i];
 
-    if (src == dest)
-        return 1;
+    for (;;) {
+        int first = 4 * i + 1, best = -1;
+        long long best_key = x.key;
 
-    visited[src] = 1;
+        for (int c = first; c < first + 4 && c < h->size; c++) {
+            if (h->a[c].key < best_key) {
+                best = c;
+                best_key = h->a[c].key;
+            }
+        }
+        if (best < 0)
+            break;
+        h->a[i] = h->a[best];
+        h->pos[h->a[i].node] = i;
+        i = best;
+    }
+    h->a[i] = x;
+    h->pos[x.node] = i;
+}
 
-    linked_list_t *neighbours = lg_get_neighbours(graph, src);
-    ll_node_t *crt = neighbours->head;
+// inserează nodul sau îi scade cheia (decrease-key)
+static void dheap_update(dheap_t *h, int node, long long key) {
+    int i = h->pos[node];
 
-    while (crt) {
-        int neighbour = *(int *)crt->data;
-        if (!visited[neighbour]) {
-            if (path_exists(graph, neighbour, dest, visited))
-                return 1;
-        }
-        crt = crt->next;
+    if (i < 0) {
+        i = h->size++;
+        h->a[i].node = node;
     }
+    h->a[i].key = key;
+    dheap_sift_up(h, i);
+}
 
-    return 0;
+static int dheap_pop(dheap_t *h) {
+    int node = h->a[0].node;
+
+    h->pos[node] = -1;
+    if (--h->size) {
+        h->a[0] = h->a[h->size];
+        dheap_sift_down(h, 0);
+    }
+    return node;
 }
 
-void component_arrays(list_graph_t* graph, int *visited, int *component, int node, int component_id) {
-    if (!graph || !graph->neighbors || node < 0 || node >= graph->nodes || visited[node])
-        return;
+/*
+ * Dijkstra pe graful cu liste. Costurile trebuie să fie >= 0; la un cost
+ * negativ se oprește și întoarce -1. dist[v] = costul minim de la start
+ * (-1 = inaccesibil), parent[v] = predecesorul pe drumul minim (-1 pentru start
+ * și nodurile inaccesibile; parent poate fi NULL). Un graf fără costuri e
+ * tratat ca având toate muchiile de cost 1. Întoarce numărul de noduri atinse.
+ */
+int dijkstra(list_graph_t *graph, int start, long long *dist, int *parent) {
+    if (!graph || start < 0 || start >= graph->nodes)
+        return -1;
 
-    visited[node] = 1;
-    component[node] = component_id;
+    int n = graph->nodes, reached = 0;
+    dheap_t h;
+    dheap_init(&h, n);
 
-    linked_list_t *neighbours = lg_get_neighbours(graph, node);
-    ll_node_t *crt = neighbours->head;
+    for (int i = 0; i < n; i++) {
+        dist[i] = -1;
+        if (parent)
+            parent[i] = -1;
+    }
+    dist[start] = 0;
+    dheap_update(&h, start, 0);
 
-    while (crt) {
-        int neighbour = *(int *)crt->data;
-        if (!visited[neighbour]) {
-            component_arrays(graph, visited, component, neighbour, component_id);
+    while (h.size) {
+        int u = dheap_pop(&h);
+        reached++;
+
+        for (ll_node_t *crt = graph->neighbors[u]->head; crt; crt = crt->next) {
+            lg_wedge_t *edge = crt->data;
+            int w = graph->weighted ? edge->weight : 1;
+
+            if (w < 0) {
+                reached = -1;
+                goto out;
+            }
+            long long nd = dist[u] + w;
+            if (dist[edge->dest] < 0 || nd < dist[edge->dest]) {
+                dist[edge->dest] = nd;
+                if (parent)
+                    parent[edge->dest] = u;
+                dheap_update(&h, edge->dest, nd);
+            }
         }
-        crt = crt->next;
     }
+
+out:
+    dheap_free(&h);
+    return reached;
 }
 
-int shortest_path_BFS(list_graph_t *graph, int start, int target)
-{
-    if (!graph || start < 0 || target < 0 ||
-        start >= graph->nodes || target >= graph->nodes)
+// la fel ca dijkstra, pe CSR (graph->weights NULL = toate costurile 1)
+int csr_dijkstra(csr_graph_t *graph, int start, long long *dist, int *parent) {
+    if (!graph || start < 0 || start >= graph->nodes)
         return -1;
 
-    int *visited = calloc(graph->nodes, sizeof(int));
-    int *dist = calloc(graph->nodes, sizeof(int));
+    int n = graph->nodes, reached = 0;
+    dheap_t h;
+    dheap_init(&h, n);
 
-    queue_t *q = q_create(sizeof(int), graph->nodes);
-    q_enqueue(q, &start);
-    visited[start] = 1;
+    for (int i = 0; i < n; i++) {
+        dist[i] = -1;
+        if (parent)
+            parent[i] = -1;
+    }
     dist[start] = 0;
+    dheap_update(&h, start, 0);
 
-    while (!q_is_empty(q)) {
-        int node = *(int *)q_front(q);
-        q_dequeue(q);
+    while (h.size) {
+        int u = dheap_pop(&h);
+        reached++;
 
-        if (node == target) {
-            int result = dist[node];
-            q_free(q);
-            free(visited);
-            free(dist);
-            return result;
-        }
+        for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+            int v = graph->adj[e];
+            int w = graph->weights ? graph->weights[e] : 1;
 
-        linked_list_t *neigh = lg_get_neighbours(graph, node);
-        ll_node_t *crt = neigh->head;
-        while (crt) {
-            int v = *(int *)crt->data;
-            if (!visited[v]) {
-                visited[v] = 1;
-                dist[v] = dist[node] + 1;
-                q_enqueue(q, &v);
+            if (w < 0) {
+                reached = -1;
+                goto out;
+            }
+            long long nd = dist[u] + w;
+            if (dist[v] < 0 || nd < dist[v]) {
+                dist[v] = nd;
+                if (parent)
+                    parent[v] = u;
+                dheap_update(&h, v, nd);
             }
-            crt = crt->next;
         }
     }
 
-    q_free(q);
-    free(visited);
-    free(dist);
-    return -1; // dacă target nu e accesibil
+out:
+    dheap_free(&h);
+    return reached;
 }
 
-void dfs_order(list_graph_t *graph, int node, int *visited, int *stack, int *stack_top) {
-    visited[node] = 1;
-    linked_list_t *neigh = lg_get_neighbours(graph, node);
-    for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
-        int v = *(int *)crt->data;
-        if (!visited[v])
-            dfs_order(graph, v, visited, stack, stack_top);
+#define DELTA_STEP_CHUNK 64
+#define DELTA_STEP_MAX_BUCKETS (1 << 16)
+
+typedef struct {
+    csr_graph_t *graph;
+    long long *dist;        // LLONG_MAX cât timp nodul nu e atins
+    long long delta;
+    long long cur;          // indicele găleții curente
+    int_buf_t *buckets;     // circulare: găleata b stă în buckets[b % nb], cu b + nb, ...
+    int nb;
+    int *frontier;          // nodurile de procesat acum, fără duplicate
+    unsigned int size;
+    unsigned int cursor;
+    int *stamp;             // frontier nu primește același nod de două ori
+    int round;
+    int_buf_t *out;         // per thread: nodurile a căror dist a scăzut
+    int_buf_t *settled;     // per thread: nodurile scoase din găleata curentă
+    int threads;
+    int done;
+    pthread_barrier_t barrier;
+} delta_step_t;
+
+typedef struct {
+    delta_step_t *shared;
+    int tid;
+} delta_step_arg_t;
+
+// min atomic pe dist[v]; 1 dacă nd a câștigat
+static int delta_step_relax(long long *dist, int v, long long nd) {
+    long long old = __atomic_load_n(&dist[v], __ATOMIC_RELAXED);
+
+    while (nd < old) {
+        if (__atomic_compare_exchange_n(&dist[v], &old, nd, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            return 1;
     }
-    stack[(*stack_top)++] = node;
+    return 0;
 }
 
-list_graph_t* transpose_graph(list_graph_t *graph) {
-    list_graph_t *t_graph = lg_create(graph->nodes);
-    for (int u = 0; u < graph->nodes; u++) {
-        linked_list_t *neigh = lg_get_neighbours(graph, u);
-        for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
-            int v = *(int *)crt->data;
-            lg_add_edge(t_graph, v, u);  // inversăm direcția
+// relaxează muchiile ușoare (light = 1, cost <= delta) sau grele ale frontierei
+static void delta_step_relax_all(delta_step_t *d, int_buf_t *out, int_buf_t *settled, int light) {
+    csr_graph_t *graph = d->graph;
+    unsigned int i;
+
+    while ((i = __atomic_fetch_add(&d->cursor, DELTA_STEP_CHUNK, __ATOMIC_RELAXED)) < d->size) {
+        unsigned int stop = i + DELTA_STEP_CHUNK < d->size ? i + DELTA_STEP_CHUNK : d->size;
+
+        for (; i < stop; i++) {
+            int u = d->frontier[i];
+            long long du = __atomic_load_n(&d->dist[u], __ATOMIC_RELAXED);
+
+            if (settled)
+                int_buf_push(settled, u);
+
+            for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+                int w = graph->weights ? graph->weights[e] : 1;
+
+                if ((w <= d->delta) != light)
+                    continue;
+                if (delta_step_relax(d->dist, graph->adj[e], du + w))
+                    int_buf_push(out, graph->adj[e]);
+            }
         }
     }
-    return t_graph;
 }
 
-void dfs_assign(list_graph_t *graph, int node, int *visited, int *component, int comp_id) {
-    visited[node] = 1;
-    component[node] = comp_id;
-    linked_list_t *neigh = lg_get_neighbours(graph, node);
-    for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
-        int v = *(int *)crt->data;
-        if (!visited[v])
-            dfs_assign(graph, v, visited, component, comp_id);
+static void delta_step_add(delta_step_t *d, int v) {
+    if (d->stamp[v] != d->round) {
+        d->stamp[v] = d->round;
+        d->frontier[d->size++] = v;
     }
 }
 
-void find_strongly_connected_components(list_graph_t *graph, int *component, int *num_components) {
-    int n = graph->nodes;
-    int *visited = calloc(n, sizeof(int));
-    int *stack = malloc(n * sizeof(int));
-    int stack_top = 0;
+// thread 0: nodurile noi rămân în găleata curentă sau pleacă în găleata lor
+static void delta_step_refill(delta_step_t *d) {
+    d->round++;
+    d->size = d->cursor = 0;
+    for (int t = 0; t < d->threads; t++) {
+        for (unsigned int i = 0; i < d->out[t].size; i++) {
+            int v = d->out[t].data[i];
+            long long b = d->dist[v] / d->delta;
+
+            if (b == d->cur)
+                delta_step_add(d, v);
+            else
+                int_buf_push(&d->buckets[b % d->nb], v);
+        }
+        d->out[t].size = 0;
+    }
+}
 
-    // 1. DFS pentru ordine
-    for (int i = 0; i < n; i++) {
-        if (!visited[i])
-            dfs_order(graph, i, visited, stack, &stack_top);
+// thread 0: frontiera pentru muchiile grele = nodurile găleții, o singură dată
+static void delta_step_collect(delta_step_t *d) {
+    d->round++;
+    d->size = d->cursor = 0;
+    for (int t = 0; t < d->threads; t++) {
+        for (unsigned int i = 0; i < d->settled[t].size; i++)
+            delta_step_add(d, d->settled[t].data[i]);
+        d->settled[t].size = 0;
     }
+}
 
-    // 2. Transpune
-    list_graph_t *t_graph = transpose_graph(graph);
+/*
+ * thread 0: trece la următoarea găleată nevidă; intrările învechite se sar.
+ * Când nb e limitat, buckets[b % nb] ține și găleți de după b: acelea rămân,
+ * iar dacă un ciclu întreg nu găsește nimic sărim direct la cea mai mică.
+ */
+static void delta_step_next_bucket(delta_step_t *d) {
+    delta_step_refill(d);   // după muchiile grele nimic nu mai e în găleata curentă
+
+    long long b = d->cur, next = LLONG_MAX;
+    int scanned = 0;
+
+    while (!d->size) {
+        if (scanned == d->nb) {
+            if (next == LLONG_MAX)
+                break;
+            b = next - 1;
+            next = LLONG_MAX;
+            scanned = 0;
+        }
+        b++;
+        scanned++;
+
+        int_buf_t *bucket = &d->buckets[b % d->nb];
+        unsigned int keep = 0;
+        for (unsigned int i = 0; i < bucket->size; i++) {
+            int v = bucket->data[i];
+            long long bv = d->dist[v] / d->delta;
+
+            if (bv == b) {
+                delta_step_add(d, v);
+            } else if (bv > b) {
+                bucket->data[keep++] = v;
+                if (bv < next)
+                    next = bv;
+            }
+        }
+        bucket->size = keep;
+    }
 
-    // 3. DFS în ordinea inversă
-    for (int i = 0; i < n; i++) visited[i] = 0;
-    *num_components = 0;
+    if (d->size)
+        d->cur = b;
+    else
+        d->done = 1;
+}
 
-    for (int i = stack_top - 1; i >= 0; i--) {
-        int node = stack[i];
-        if (!visited[node]) {
-            dfs_assign(t_graph, node, visited, component, *num_components);
-            (*num_components)++;
+static void *delta_step_worker(void *arg) {
+    delta_step_arg_t *a = arg;
+    delta_step_t *d = a->shared;
+
+    while (!d->done) {
+        // muchiile ușoare pot readuce noduri în găleata curentă, deci se repetă
+        while (d->size) {
+            delta_step_relax_all(d, d->out + a->tid, d->settled + a->tid, 1);
+            pthread_barrier_wait(&d->barrier);
+            if (a->tid == 0)
+                delta_step_refill(d);
+            pthread_barrier_wait(&d->barrier);
         }
+
+        // toți trebuie să fi citit d->size înainte ca thread 0 să-l refolosească
+        pthread_barrier_wait(&d->barrier);
+        if (a->tid == 0)
+            delta_step_collect(d);
+        pthread_barrier_wait(&d->barrier);
+        delta_step_relax_all(d, d->out + a->tid, NULL, 0);
+        pthread_barrier_wait(&d->barrier);
+        if (a->tid == 0)
+            delta_step_next_bucket(d);
+        pthread_barrier_wait(&d->barrier);
     }
 
-    // curățenie
-    free(stack);
-    free(visited);
-    lg_free(t_graph);
+    return NULL;
 }
 
-void topological_sort(list_graph_t *graph, int *visited, int *stack, int *stack_top, int node) {
-    visited[node] = 1;
-    linked_list_t *neigh = lg_get_neighbours(graph, node);
-    for (ll_node_t *crt = neigh->head; crt; crt = crt->next) {
-        int v = *(int *)crt->data;
-        if (!visited[v])
-            topological_sort(graph, visited, stack, stack_top, v);
+// părinții din dist: BFS pe muchiile "strânse" (dist[u] + w == dist[v])
+static void sp_parents(csr_graph_t *graph, int start, const long long *dist, int *parent) {
+    int *queue = malloc(graph->nodes * sizeof(int));
+    DIE(!queue, "malloc queue failed");
+
+    for (int i = 0; i < graph->nodes; i++)
+        parent[i] = -1;
+
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    parent[start] = start;  // marcat; refăcut la -1 la final
+    while (head != tail) {
+        int u = queue[head++];
+        for (unsigned int e = graph->offsets[u]; e != graph->offsets[u + 1]; e++) {
+            int v = graph->adj[e];
+            int w = graph->weights ? graph->weights[e] : 1;
+
+            if (parent[v] < 0 && dist[u] + w == dist[v]) {
+                parent[v] = u;
+                queue[tail++] = v;
+            }
+        }
     }
-    stack[(*stack_top)++] = node;
+    parent[start] = -1;
+
+    free(queue);
+}
+
+/*
+ * Delta-stepping paralel: nodurile sunt grupate în găleți de lățime delta după
+ * dist; găleata curentă se golește în paralel relaxând întâi muchiile ușoare
+ * (cost <= delta, până nu mai apar noduri noi în ea), apoi o dată pe cele
+ * grele. delta <= 0 alege singur delta = cost maxim / grad mediu. Rezultatele
+ * sunt ca la csr_dijkstra (dist identic; parent poate alege alt drum de același
+ * cost). Întoarce numărul de noduri atinse sau -1 la un cost negativ ori
+ * threads < 1.
+ */
+int csr_delta_stepping(csr_graph_t *graph, int start, long long delta, int threads,
+                       long long *dist, int *parent) {
+    if (!graph || start < 0 || start >= graph->nodes || threads < 1)
+        return -1;
+
+    int n = graph->nodes;
+    long long max_w = 1;
+    if (graph->weights) {
+        max_w = 0;
+        for (unsigned int e = 0; e < graph->edges; e++) {
+            if (graph->weights[e] < 0)
+                return -1;
+            if (graph->weights[e] > max_w)
+                max_w = graph->weights[e];
+        }
+    }
+    if (delta <= 0) {
+        long long avg_degree = n ? graph->edges / n : 0;
+        delta = max_w / (avg_degree ? avg_degree : 1);
+        if (delta < 1)
+            delta = 1;
+    }
+
+    delta_step_t d;
+    d.graph = graph;
+    d.dist = dist;
+    d.delta = delta;
+    d.cur = 0;
+    // cu max_w / delta + 2 găleți fiecare are doar nodurile ei; peste limită se refolosesc
+    d.nb = max_w / delta + 2 < DELTA_STEP_MAX_BUCKETS ? max_w / delta + 2 : DELTA_STEP_MAX_BUCKETS;
+    d.buckets = calloc(d.nb, sizeof(int_buf_t));
+    d.frontier = malloc(n * sizeof(int));
+    d.stamp = calloc(n, sizeof(int));
+    d.out = calloc(threads, sizeof(int_buf_t));
+    d.settled = calloc(threads, sizeof(int_buf_t));
+    delta_step_arg_t *args = malloc(threads * sizeof(*args));
+    pthread_t *tids = malloc(threads * sizeof(*tids));
+    DIE(!d.buckets || !d.frontier || !d.stamp || !d.out || !d.settled || !args || !tids,
+        "malloc delta-stepping buffers failed");
+    d.round = 0;
+    d.threads = threads;
+    d.done = 0;
+    DIE(pthread_barrier_init(&d.barrier, NULL, threads), "pthread_barrier_init");
+
+    for (int i = 0; i < n; i++)
+        dist[i] = LLONG_MAX;
+    dist[start] = 0;
+    d.frontier[0] = start;
+    d.size = 1;
+    d.cursor = 0;
+
+    for (int t = 0; t < threads; t++) {
+        args[t].shared = &d;
+        args[t].tid = t;
+    }
+    for (int t = 1; t < threads; t++)
+        DIE(pthread_create(tids + t, NULL, delta_step_worker, args + t), "pthread_create");
+    delta_step_worker(args);
+    for (int t = 1; t < threads; t++)
+        pthread_join(tids[t], NULL);
+
+    int reached = 0;
+    for (int i = 0; i < n; i++) {
+        if (dist[i] == LLONG_MAX)
+            dist[i] = -1;
+        else
+            reached++;
+    }
+    if (parent)
+        sp_parents(graph, start, dist, parent);
+
+    pthread_barrier_destroy(&d.barrier);
+    for (int b = 0; b < d.nb; b++)
+        free(d.buckets[b].data);
+    for (int t = 0; t < threads; t++) {
+        free(d.out[t].data);
+        free(d.settled[t].data);
+    }
+    free(tids);
+    free(args);
+    free(d.settled);
+    free(d.out);
+    free(d.stamp);
+    free(d.frontier);
+    free(d.buckets);
+    return reached;
 }